@@ -0,0 +1,261 @@
+#include "spdlog/spdlog.h"
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "contract_manager.h"
+#include "../data_layer/error.h"
+#include "../data_layer/server_clock.h"
+
+using namespace automation;
+using namespace schema;
+
+// ----------------------------------------------------------------
+// a failed refresh is tried again after this, rather than on every ship's step
+const std::chrono::seconds failedRefreshDelay(60);
+// ----------------------------------------------------------------
+
+ContractManager::ContractManager(std::chrono::seconds refreshInterval)
+    : refreshInterval(refreshInterval), logger("Contracts")
+{
+}
+
+void ContractManager::refresh(dal::DataAccessLayer &DALInstance)
+{
+    std::unique_lock<std::mutex> refreshing(refreshMutex, std::try_to_lock);
+    if (!refreshing.owns_lock())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (std::chrono::steady_clock::now() < nextRefresh)
+        {
+            return;
+        }
+    }
+
+    logger.info("Refreshing contracts...");
+    std::vector<Contract> fetched;
+    try
+    {
+        fetched = DALInstance.getContracts(dal::BACKGROUND);
+    }
+    catch (const std::exception &e)
+    {
+        // the cached contracts stay in use, ships go on selling and delivering against them
+        logger.warn("Could not refresh contracts, retrying in {} s: {}", failedRefreshDelay.count(), e.what());
+        std::lock_guard<std::mutex> lock(mutex);
+        nextRefresh = std::chrono::steady_clock::now() + failedRefreshDelay;
+        return;
+    }
+    std::vector<std::string> completed;
+    for (auto &contract : fetched)
+    {
+        if (contract.accepted || contract.fulfilled)
+        {
+            if (contract.accepted && !contract.fulfilled && contract.isComplete())
+            {
+                completed.push_back(contract.id);
+            }
+            continue;
+        }
+        if (isExpired(contract))
+        {
+            logger.info("Contract {} has expired, skipping...", contract.id);
+            continue;
+        }
+
+        try
+        {
+            logger.info("Accepting contract {}...", contract.id);
+            contract = DALInstance.acceptContract(contract.id, dal::BACKGROUND);
+        }
+        catch (const error::BaseException &e)
+        {
+            logger.warn("Could not accept contract {}: {}", contract.id, e.what());
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        contracts.clear();
+        for (auto &contract : fetched)
+        {
+            if (contract.accepted && !contract.fulfilled)
+            {
+                contracts[contract.id] = contract;
+                for (auto &good : contract.deliver)
+                {
+                    logger.info("Contract {}: {} more {} to {}.", contract.id, contract.getRemaining(good.tradeSymbol), good.tradeSymbol, good.destinationSymbol);
+                }
+            }
+        }
+        nextRefresh = std::chrono::steady_clock::now() + refreshInterval;
+    }
+
+    for (auto &contractId : completed)
+    {
+        fulfill(contractId, DALInstance);
+    }
+}
+
+bool ContractManager::isExpired(const Contract &contract)
+{
+    if (contract.deadline.empty())
+    {
+        return false;
+    }
+    try
+    {
+        return dal::ServerClock::parseTimestamp(contract.deadline) < std::chrono::system_clock::now();
+    }
+    catch (const std::invalid_argument &e)
+    {
+        // not worth accepting what cannot be planned for
+        logger.warn("Contract {} has an unreadable deadline: {}", contract.id, e.what());
+        return true;
+    }
+}
+
+std::unordered_set<std::string> ContractManager::getWantedGoods() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unordered_set<std::string> goods;
+    for (auto &contract : contracts)
+    {
+        for (auto &good : contract.second.deliver)
+        {
+            if (getUnreserved(contract.second, good.tradeSymbol) > 0)
+            {
+                goods.insert(good.tradeSymbol);
+            }
+        }
+    }
+    return goods;
+}
+
+bool ContractManager::assign(const Ship &ship, std::vector<DeliveryAssignment> &assignments)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    assignments.clear();
+    bool holdFull = ship.cargo.units >= ship.cargo.capacity;
+    std::string destination;
+    // units already handed to an earlier contract line of this ship
+    std::map<std::string, int> taken;
+    // two passes: a good that is worth the trip picks the destination, then everything else for it rides along
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (auto &contract : contracts)
+        {
+            for (auto &good : contract.second.deliver)
+            {
+                int held = 0;
+                for (auto &item : ship.cargo.inventory)
+                {
+                    if (item.symbol == good.tradeSymbol)
+                    {
+                        held += item.units;
+                    }
+                }
+                held -= taken[good.tradeSymbol];
+                int unreserved = getUnreserved(contract.second, good.tradeSymbol);
+                if (held <= 0 || unreserved <= 0)
+                {
+                    continue;
+                }
+                if (pass == 0)
+                {
+                    // a partial load is only worth the trip if it is the last one the contract needs
+                    if (destination.empty() && (held >= unreserved || holdFull))
+                    {
+                        destination = good.destinationSymbol;
+                    }
+                    continue;
+                }
+                if (good.destinationSymbol != destination)
+                {
+                    continue;
+                }
+
+                DeliveryAssignment assignment;
+                assignment.contractId = contract.first;
+                assignment.tradeSymbol = good.tradeSymbol;
+                assignment.destinationSymbol = good.destinationSymbol;
+                assignment.units = std::min(held, unreserved);
+                reserved[contract.first][good.tradeSymbol] += assignment.units;
+                taken[good.tradeSymbol] += assignment.units;
+                assignments.push_back(assignment);
+            }
+        }
+        if (destination.empty())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ContractManager::release(const DeliveryAssignment &assignment)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    int &units = reserved[assignment.contractId][assignment.tradeSymbol];
+    units = std::max(0, units - assignment.units);
+}
+
+void ContractManager::reserve(const DeliveryAssignment &assignment)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    reserved[assignment.contractId][assignment.tradeSymbol] += assignment.units;
+}
+
+void ContractManager::delivered(const DeliveryAssignment &assignment, const Contract &contract, dal::DataAccessLayer &DALInstance)
+{
+    release(assignment);
+    bool complete;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        contracts[contract.id] = contract;
+        complete = contract.isComplete() && !contract.fulfilled;
+        logger.info("Contract {}: {} more {} to go.", contract.id, contract.getRemaining(assignment.tradeSymbol), assignment.tradeSymbol);
+    }
+    if (complete)
+    {
+        fulfill(contract.id, DALInstance);
+    }
+}
+
+int ContractManager::getUnreserved(const Contract &contract, const std::string &tradeSymbol) const
+{
+    int remaining = contract.getRemaining(tradeSymbol);
+    auto onContract = reserved.find(contract.id);
+    if (onContract == reserved.end())
+    {
+        return remaining;
+    }
+    auto onGood = onContract->second.find(tradeSymbol);
+    return onGood == onContract->second.end() ? remaining : remaining - onGood->second;
+}
+
+void ContractManager::fulfill(const std::string &contractId, dal::DataAccessLayer &DALInstance)
+{
+    try
+    {
+        logger.info("Fulfilling contract {}...", contractId);
+        DALInstance.fulfillContract(contractId, dal::BACKGROUND);
+    }
+    catch (const std::exception &e)
+    {
+        // a timeout included, it must not cut short the deliveries of the ship calling in
+        logger.warn("Could not fulfill contract {}: {}", contractId, e.what());
+        return;
+    }
+
+    // look for new work straight away
+    std::lock_guard<std::mutex> lock(mutex);
+    contracts.erase(contractId);
+    reserved.erase(contractId);
+    nextRefresh = std::chrono::steady_clock::now();
+}
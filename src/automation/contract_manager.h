@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../data_layer/data_access.h"
+#include "../data_layer/schema.h"
+#include "../data_layer/logging.h"
+
+namespace automation
+{
+    struct DeliveryAssignment
+    {
+        std::string contractId;
+        std::string tradeSymbol;
+        std::string destinationSymbol;
+        int units = 0;
+    };
+
+    /* Tracks the agent's contracts in place of compile time constants. Contracts are fetched
+    again every refreshInterval, open ones are accepted on sight and finished ones fulfilled,
+    so new work is picked up without a restart.
+
+    Delivery work is handed out in batches: a ship is only sent when the contract goods it
+    carries fill its hold or finish what is left of the contract. Units on their way are
+    reserved, so two ships never race to deliver the same remainder and the rest of the
+    fleet keeps mining for whatever is still missing.
+    Shared by every ship of the fleet, all calls are thread safe.
+    */
+    class ContractManager
+    {
+    public:
+        ContractManager(std::chrono::seconds refreshInterval = std::chrono::seconds(300));
+
+        // does nothing until the interval has passed, or while another ship is already refreshing
+        void refresh(dal::DataAccessLayer &DALInstance);
+        // goods some accepted contract still needs more of than is already on its way
+        std::unordered_set<std::string> getWantedGoods() const;
+        // false while the ship's contract goods are not yet worth a trip, otherwise everything
+        // aboard for the same destination is handed out together
+        bool assign(const schema::Ship &ship, std::vector<DeliveryAssignment> &assignments);
+        void release(const DeliveryAssignment &assignment);
+        // takes back a reservation that was handed out before a restart
+        void reserve(const DeliveryAssignment &assignment);
+        // fulfills the contract once the delivery completes it
+        void delivered(const DeliveryAssignment &assignment, const schema::Contract &contract, dal::DataAccessLayer &DALInstance);
+
+    private:
+        int getUnreserved(const schema::Contract &contract, const std::string &tradeSymbol) const;
+        // a deadline that cannot be read counts as expired
+        bool isExpired(const schema::Contract &contract);
+        void fulfill(const std::string &contractId, dal::DataAccessLayer &DALInstance);
+
+        std::chrono::seconds refreshInterval;
+        std::chrono::steady_clock::time_point nextRefresh;
+        std::map<std::string, schema::Contract> contracts;
+        // contract id -> trade symbol -> units on their way
+        std::map<std::string, std::map<std::string, int>> reserved;
+        logging::Logger logger;
+        mutable std::mutex mutex;
+        std::mutex refreshMutex;
+    };
+}
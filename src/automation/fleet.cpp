@@ -0,0 +1,58 @@
+#include "fleet.h"
+
+#include <algorithm>
+#include <exception>
+#include "../data_layer/logging.h"
+
+using namespace automation;
+
+Fleet::Fleet(const std::vector<std::string> &asteroidFields)
+    : miningPlanner(asteroidFields, waypoints, markets), sellPlanner(markets, waypoints), routePlanner(waypoints)
+{
+}
+
+void Fleet::load(dal::DataAccessLayer &DALInstance, const std::string &systemSymbol)
+{
+    logging::Logger logger("Fleet");
+    logger.info("Loading the waypoints of {}...", systemSymbol);
+    std::vector<schema::Waypoint> systemWaypoints;
+    try
+    {
+        systemWaypoints = DALInstance.getWaypoints(systemSymbol, dal::BACKGROUND);
+    }
+    catch (const std::exception &e)
+    {
+        // timeouts included, the map still fills up from the nav routes the ships fly
+        logger.warn("Could not load the waypoints of {}: {}", systemSymbol, e.what());
+        return;
+    }
+
+    int marketCount = 0;
+    for (auto &waypoint : systemWaypoints)
+    {
+        waypoints.add(waypoint);
+        if (!waypoint.hasTrait("MARKETPLACE"))
+        {
+            continue;
+        }
+        try
+        {
+            updateMarket(DALInstance.getMarket(systemSymbol, waypoint.symbol, dal::BACKGROUND));
+            marketCount++;
+        }
+        catch (const std::exception &e)
+        {
+            logger.warn("No market data at {}: {}", waypoint.symbol, e.what());
+        }
+    }
+    logger.info("Loaded {} waypoints and {} markets of {}.", systemWaypoints.size(), marketCount, systemSymbol);
+}
+
+void Fleet::updateMarket(const schema::Market &market)
+{
+    bool sellsFuel = std::find(market.tradeSymbols.begin(), market.tradeSymbols.end(), "FUEL") != market.tradeSymbols.end() ||
+                     std::any_of(market.tradeGoods.begin(), market.tradeGoods.end(), [](const schema::TradeGood &good)
+                                 { return good.symbol == "FUEL"; });
+    waypoints.setFuelStation(market.symbol, sellsFuel);
+    markets.update(market);
+}
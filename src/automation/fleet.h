@@ -0,0 +1,41 @@
+#pragma once
+
+#include "spdlog/spdlog.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "waypoint_map.h"
+#include "market_cache.h"
+#include "mining_planner.h"
+#include "sell_planner.h"
+#include "contract_manager.h"
+#include "route_planner.h"
+#include "fleet_store.h"
+#include "ship_journal.h"
+#include "../data_layer/data_access.h"
+
+namespace automation
+{
+    // what every ship of the fleet learns from and plans with, one instance shared by all automators
+    struct Fleet
+    {
+        Fleet(const std::vector<std::string> &asteroidFields);
+
+        // caches every waypoint of the system and the markets that list their goods up front
+        void load(dal::DataAccessLayer &DALInstance, const std::string &systemSymbol);
+        // prices for the market cache, fuel on sale for the route planner
+        void updateMarket(const schema::Market &market);
+
+        WaypointMap waypoints;
+        MarketCache markets;
+        MiningPlanner miningPlanner;
+        SellPlanner sellPlanner;
+        ContractManager contracts;
+        RoutePlanner routePlanner;
+        FleetStore ships;
+        // only set when the state of the ships is kept across restarts
+        std::unique_ptr<ShipJournal> journal;
+    };
+}
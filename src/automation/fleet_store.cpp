@@ -0,0 +1,89 @@
+#include "fleet_store.h"
+
+#include <exception>
+#include <functional>
+
+using namespace automation;
+
+FleetStore::FleetStore(std::chrono::seconds refreshInterval)
+    : refreshInterval(refreshInterval), logger("FleetStore")
+{
+}
+
+void FleetStore::publish(const schema::Ship &ship, std::chrono::steady_clock::time_point since)
+{
+    // the copy is made before the lock is taken
+    std::shared_ptr<const schema::Ship> version = std::make_shared<const schema::Ship>(ship);
+    Shard &entry = shard(ship.symbol);
+    std::lock_guard<std::mutex> lock(entry.mutex);
+    ShipSnapshot &current = entry.ships[ship.symbol];
+    if (current.ship != nullptr && current.since > since)
+    {
+        return;
+    }
+    current.ship = std::move(version);
+    current.since = since;
+}
+
+ShipSnapshot FleetStore::get(const std::string &shipSymbol) const
+{
+    const Shard &entry = shard(shipSymbol);
+    std::lock_guard<std::mutex> lock(entry.mutex);
+    auto found = entry.ships.find(shipSymbol);
+    if (found == entry.ships.end())
+    {
+        return ShipSnapshot();
+    }
+    return found->second;
+}
+
+std::vector<ShipSnapshot> FleetStore::getAll() const
+{
+    // consistent per ship, not across ships
+    std::vector<ShipSnapshot> snapshots;
+    for (auto &entry : shards)
+    {
+        std::lock_guard<std::mutex> lock(entry.mutex);
+        for (auto &ship : entry.ships)
+        {
+            snapshots.push_back(ship.second);
+        }
+    }
+    return snapshots;
+}
+
+std::chrono::milliseconds FleetStore::refresh(dal::DataAccessLayer &DALInstance)
+{
+    // the listing is only as new as the moment it was asked for
+    auto requestedAt = std::chrono::steady_clock::now();
+    try
+    {
+        std::vector<schema::Ship> ships = DALInstance.getShips(dal::BACKGROUND);
+        for (auto &ship : ships)
+        {
+            publish(ship, requestedAt);
+        }
+        logger.info("Refreshed {} ships.", ships.size());
+    }
+    catch (const std::exception &e)
+    {
+        // timeouts and dropped connections included, the next try waits a full interval all the same
+        logger.warn("Could not refresh the fleet: {}", e.what());
+    }
+    return getRefreshInterval();
+}
+
+std::chrono::milliseconds FleetStore::getRefreshInterval() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(refreshInterval);
+}
+
+FleetStore::Shard &FleetStore::shard(const std::string &shipSymbol)
+{
+    return shards[std::hash<std::string>()(shipSymbol) % SHARDS];
+}
+
+const FleetStore::Shard &FleetStore::shard(const std::string &shipSymbol) const
+{
+    return shards[std::hash<std::string>()(shipSymbol) % SHARDS];
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "spdlog/spdlog.h"
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../data_layer/schema.h"
+#include "../data_layer/data_access.h"
+#include "../data_layer/logging.h"
+
+namespace automation
+{
+    // one immutable version of a ship, valid from the moment it was known to the server
+    struct ShipSnapshot
+    {
+        std::shared_ptr<const schema::Ship> ship;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    /* The last known state of every ship of the fleet, for planners to read without asking the
+    server. Versions are never changed in place: a writer builds a new ship and swaps the pointer,
+    so a reader holds on to a consistent copy for as long as it likes. Ships are spread over
+    shards by symbol and a shard is locked only to swap or copy a pointer, so readers and writers
+    of different ships never meet and those of the same ship only for that long.
+
+    Each automator publishes its ship after every step, and refresh() lists /my/ships page by page
+    on a schedule. A version never replaces a newer one, so a listing that was requested before a
+    ship acted cannot undo what the ship did. Thread safe.
+    */
+    class FleetStore
+    {
+    public:
+        FleetStore(std::chrono::seconds refreshInterval = std::chrono::seconds(300));
+
+        void publish(const schema::Ship &ship, std::chrono::steady_clock::time_point since);
+        // an empty snapshot if the ship is unknown
+        ShipSnapshot get(const std::string &shipSymbol) const;
+        std::vector<ShipSnapshot> getAll() const;
+
+        // lists every ship again, returns the delay until the next refresh is due
+        std::chrono::milliseconds refresh(dal::DataAccessLayer &DALInstance);
+        std::chrono::milliseconds getRefreshInterval() const;
+
+    private:
+        static const int SHARDS = 16;
+
+        struct Shard
+        {
+            std::unordered_map<std::string, ShipSnapshot> ships;
+            mutable std::mutex mutex;
+        };
+
+        Shard &shard(const std::string &shipSymbol);
+        const Shard &shard(const std::string &shipSymbol) const;
+
+        std::array<Shard, SHARDS> shards;
+        std::chrono::seconds refreshInterval;
+        logging::Logger logger;
+    };
+}
@@ -0,0 +1,172 @@
+#include "fleet_table.h"
+
+#include <algorithm>
+
+using namespace automation;
+
+// ------------------------- Parameters ---------------------------
+// once the clock is this far past the origin, about six days, the origin is moved up to keep deadlines in range
+const std::chrono::milliseconds rebaseAfter(1 << 29);
+// rows per scan block, 4KiB of deadlines stays in L1 for the second walk
+const std::size_t scanBlock = 1024;
+// deadlines further out are cut short, the job just runs early
+const std::int32_t maxWait = 1 << 30;
+// ----------------------------------------------------------------
+
+const std::int32_t FleetTable::IDLE;
+// marks the rows found due during a scan, real deadlines are never negative
+const std::int32_t DUE = -1;
+
+SymbolTable::SymbolTable()
+{
+    ids[""] = 0;
+}
+
+std::uint32_t SymbolTable::intern(const std::string &symbol)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto entry = ids.find(symbol);
+    if (entry != ids.end())
+    {
+        return entry->second;
+    }
+    std::uint32_t id = (std::uint32_t)ids.size();
+    ids.emplace(symbol, id);
+    return id;
+}
+
+FleetTable::FleetTable(Clock::time_point origin) : origin(origin), earliest(IDLE)
+{
+}
+
+std::size_t FleetTable::addRow()
+{
+    wakeAt.push_back(IDLE);
+    shipIds.push_back(0);
+    statuses.push_back(0);
+    waypointIds.push_back(0);
+    targetIds.push_back(0);
+    return wakeAt.size() - 1;
+}
+
+void FleetTable::setWake(std::size_t row, Clock::time_point due)
+{
+    wakeAt[row] = toDeadline(due);
+    earliest = std::min(earliest, wakeAt[row]);
+}
+
+void FleetTable::setShip(std::size_t row, std::uint32_t shipId, std::uint8_t status, std::uint32_t waypointId, std::uint32_t targetId)
+{
+    shipIds[row] = shipId;
+    statuses[row] = status;
+    waypointIds[row] = waypointId;
+    targetIds[row] = targetId;
+}
+
+void FleetTable::collectDue(Clock::time_point now, std::vector<std::size_t> &due)
+{
+    if (now - origin >= rebaseAfter)
+    {
+        rebase(std::chrono::duration_cast<std::chrono::milliseconds>(now - origin));
+    }
+    const std::int32_t current = toElapsed(now);
+    if (current < earliest)
+    {
+        return;
+    }
+
+    // in blocks that stay in L1, each one is scanned in a branch free loop the compiler vectorizes:
+    // the mask is all ones for a due row, which turns its deadline into DUE and, as deadlines are
+    // not negative, into IDLE for the minimum. Only a block with due rows is walked a second time.
+    const std::size_t rows = wakeAt.size();
+    std::int32_t *p_wake = wakeAt.data();
+    std::int32_t next = IDLE;
+    for (std::size_t start = 0; start < rows; start += scanBlock)
+    {
+        const std::size_t end = std::min(rows, start + scanBlock);
+        std::int32_t count = 0;
+        for (std::size_t i = start; i < end; i++)
+        {
+            const std::int32_t deadline = p_wake[i];
+            const std::int32_t dueMask = -(std::int32_t)(deadline <= current);
+            count -= dueMask;
+            next = std::min(next, deadline | (dueMask & IDLE));
+            p_wake[i] = deadline | dueMask;
+        }
+        for (std::size_t i = start; count > 0; i++)
+        {
+            if (p_wake[i] == DUE)
+            {
+                p_wake[i] = IDLE;
+                due.push_back(i);
+                count--;
+            }
+        }
+    }
+    earliest = next;
+}
+
+FleetTable::Clock::time_point FleetTable::nextDue() const
+{
+    if (earliest == IDLE)
+    {
+        return Clock::time_point::max();
+    }
+    return origin + std::chrono::milliseconds(earliest);
+}
+
+std::size_t FleetTable::size() const
+{
+    return wakeAt.size();
+}
+
+void FleetTable::countStatuses(std::vector<int> &counts) const
+{
+    for (std::size_t i = 0; i < statuses.size(); i++)
+    {
+        if (shipIds[i] != 0 && statuses[i] < counts.size())
+        {
+            counts[statuses[i]]++;
+        }
+    }
+}
+
+std::int32_t FleetTable::toDeadline(Clock::time_point time) const
+{
+    // rounded up so a row is never due early, a row due before the origin is simply due
+    if (time <= origin)
+    {
+        return 0;
+    }
+    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(time - origin + std::chrono::milliseconds(1) - Clock::duration(1));
+    return (std::int32_t)std::min<std::chrono::milliseconds::rep>(wait.count(), maxWait);
+}
+
+std::int32_t FleetTable::toElapsed(Clock::time_point time) const
+{
+    // rounded down, a row only counts as due once its deadline has fully passed
+    if (time <= origin)
+    {
+        return 0;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(time - origin);
+    return (std::int32_t)std::min<std::chrono::milliseconds::rep>(elapsed.count(), maxWait);
+}
+
+void FleetTable::rebase(std::chrono::milliseconds offset)
+{
+    origin += offset;
+    // deadlines never exceed maxWait, so a longer shift makes every one of them due all the same
+    const std::int32_t shift = (std::int32_t)std::min<std::chrono::milliseconds::rep>(offset.count(), IDLE - 1);
+    for (std::int32_t &deadline : wakeAt)
+    {
+        if (deadline != IDLE)
+        {
+            deadline = std::max(0, deadline - shift);
+        }
+    }
+    if (earliest != IDLE)
+    {
+        earliest = std::max(0, earliest - shift);
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace automation
+{
+    // small integer ids for ship and waypoint symbols, 0 stands for the empty string. Thread safe.
+    class SymbolTable
+    {
+    public:
+        SymbolTable();
+        std::uint32_t intern(const std::string &symbol);
+
+    private:
+        std::unordered_map<std::string, std::uint32_t> ids;
+        std::mutex mutex;
+    };
+
+    /* One row per scheduler job, kept as a structure of arrays so that finding the due jobs is a
+    scan over one contiguous column of deadlines instead of a walk over heap objects. Deadlines
+    are 32 bit milliseconds, which the compiler can compare and take the minimum of four at a
+    time with plain SSE2, and the scan has no branches for the random pattern of due rows to
+    mispredict. The earliest deadline is kept up to date, so nothing is scanned until a row is due.
+
+    Ship rows also carry the status and interned waypoint ids of their last step, so the fleet
+    can be summed up without touching the automators. Not thread safe.
+    */
+    class FleetTable
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+        // deadline of a row that is running or was never scheduled
+        static const std::int32_t IDLE = std::numeric_limits<std::int32_t>::max();
+
+        FleetTable(Clock::time_point origin = Clock::now());
+
+        std::size_t addRow();
+        void setWake(std::size_t row, Clock::time_point due);
+        void setShip(std::size_t row, std::uint32_t shipId, std::uint8_t status, std::uint32_t waypointId, std::uint32_t targetId);
+        // appends the rows due at now and marks them idle
+        void collectDue(Clock::time_point now, std::vector<std::size_t> &due);
+        // the earliest deadline, Clock::time_point::max() if no row is waiting
+        Clock::time_point nextDue() const;
+        std::size_t size() const;
+
+        // ships per status, statuses past the end of counts are left out
+        void countStatuses(std::vector<int> &counts) const;
+
+    private:
+        // milliseconds since origin, rounded up for deadlines and down for the current time
+        std::int32_t toDeadline(Clock::time_point time) const;
+        std::int32_t toElapsed(Clock::time_point time) const;
+        void rebase(std::chrono::milliseconds offset);
+
+        Clock::time_point origin;
+        std::int32_t earliest;
+        // milliseconds since origin, rounded up
+        std::vector<std::int32_t> wakeAt;
+        std::vector<std::uint32_t> shipIds;
+        std::vector<std::uint8_t> statuses;
+        std::vector<std::uint32_t> waypointIds;
+        std::vector<std::uint32_t> targetIds;
+    };
+}
@@ -0,0 +1,114 @@
+#include "market_cache.h"
+
+using namespace automation;
+
+MarketCache::MarketCache(std::chrono::seconds maxAge) : maxAge(maxAge)
+{
+}
+
+void MarketCache::update(const schema::Market &market)
+{
+    // without trade goods the listing says nothing about prices, keep what is known
+    if (market.tradeGoods.empty())
+    {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unordered_map<std::string, MarketPrice> &prices = markets[market.symbol];
+    prices.clear();
+    for (auto &good : market.tradeGoods)
+    {
+        MarketPrice &price = prices[good.symbol];
+        price.purchasePrice = good.purchasePrice;
+        price.sellPrice = good.sellPrice;
+        price.observedAt = now;
+    }
+}
+
+void MarketCache::recordSale(const std::string &waypointSymbol, const std::string &tradeSymbol, int pricePerUnit)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    MarketPrice &price = markets[waypointSymbol][tradeSymbol];
+    price.sellPrice = pricePerUnit;
+    price.observedAt = std::chrono::steady_clock::now();
+}
+
+bool MarketCache::isFresh(const std::string &waypointSymbol) const
+{
+    // a single sale does not list the rest of the market, only a full listing counts
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto market = markets.find(waypointSymbol);
+    if (market == markets.end() || market->second.empty())
+    {
+        return false;
+    }
+    for (auto &price : market->second)
+    {
+        if (!isFresh(price.second, now))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::unordered_map<std::string, MarketPrice> MarketCache::getPrices(const std::string &waypointSymbol) const
+{
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unordered_map<std::string, MarketPrice> prices;
+    auto market = markets.find(waypointSymbol);
+    if (market == markets.end())
+    {
+        return prices;
+    }
+    for (auto &price : market->second)
+    {
+        if (isFresh(price.second, now))
+        {
+            prices.insert(price);
+        }
+    }
+    return prices;
+}
+
+std::vector<std::string> MarketCache::getMarkets() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> symbols;
+    symbols.reserve(markets.size());
+    for (auto &market : markets)
+    {
+        symbols.push_back(market.first);
+    }
+    return symbols;
+}
+
+bool MarketCache::bestSellPrice(const std::string &tradeSymbol, int &price) const
+{
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    bool found = false;
+    for (auto &market : markets)
+    {
+        auto entry = market.second.find(tradeSymbol);
+        if (entry == market.second.end() || !isFresh(entry->second, now) || entry->second.sellPrice <= 0)
+        {
+            continue;
+        }
+        if (!found || entry->second.sellPrice > price)
+        {
+            price = entry->second.sellPrice;
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool MarketCache::isFresh(const MarketPrice &price, std::chrono::steady_clock::time_point now) const
+{
+    return now - price.observedAt <= maxAge;
+}
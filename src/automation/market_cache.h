@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../data_layer/schema.h"
+
+namespace automation
+{
+    struct MarketPrice
+    {
+        // zero when only a sale has been seen, sales do not tell what the market charges
+        int purchasePrice = 0;
+        int sellPrice = 0;
+        std::chrono::steady_clock::time_point observedAt;
+    };
+
+    /* Last known price of every good at every market the fleet has visited. It is fed by the
+    market endpoint and by each sale, a sale being the freshest quote there is. Prices drift,
+    so anything older than maxAge is left out of the comparisons across markets.
+    Shared by every ship of the fleet, all calls are thread safe.
+    */
+    class MarketCache
+    {
+    public:
+        MarketCache(std::chrono::seconds maxAge = std::chrono::seconds(900));
+
+        void update(const schema::Market &market);
+        void recordSale(const std::string &waypointSymbol, const std::string &tradeSymbol, int pricePerUnit);
+        bool isFresh(const std::string &waypointSymbol) const;
+        // fresh prices of one market, empty if it has never been seen
+        std::unordered_map<std::string, MarketPrice> getPrices(const std::string &waypointSymbol) const;
+        std::vector<std::string> getMarkets() const;
+        // the best fresh price any market pays for the good, false if none does
+        bool bestSellPrice(const std::string &tradeSymbol, int &price) const;
+
+    private:
+        bool isFresh(const MarketPrice &price, std::chrono::steady_clock::time_point now) const;
+
+        std::chrono::seconds maxAge;
+        std::unordered_map<std::string, std::unordered_map<std::string, MarketPrice>> markets;
+        mutable std::mutex mutex;
+    };
+}
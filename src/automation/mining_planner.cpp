@@ -0,0 +1,174 @@
+#include "mining_planner.h"
+
+#include <algorithm>
+
+using namespace automation;
+
+// ------------------------- Parameters ---------------------------
+// below this many extractions a field/mount pair is still being explored
+const int minSamples = 3;
+// another field has to beat the current one by this much to be worth the trip
+const double switchMargin = 0.1;
+// a field with too few samples is scored this much above the best measured one, so that it is worth a trip
+const double explorationBonus = 0.5;
+// until a waypoint has been seen on a route its distance is unknown
+const double unknownTravelSeconds = 120;
+// ----------------------------------------------------------------
+
+MiningPlanner::MiningPlanner(const std::vector<std::string> &asteroidFields, const WaypointMap &waypoints, const MarketCache &markets, int shipSpeed)
+    : asteroidFields(asteroidFields), p_waypoints(&waypoints), p_markets(&markets), shipSpeed(shipSpeed)
+{
+}
+
+std::string MiningPlanner::mountKey(const schema::Ship &ship)
+{
+    // the mining mounts, sorted so the same loadout always gives the same key
+    std::vector<std::string> symbols;
+    for (auto &mount : ship.mounts)
+    {
+        if (mount.symbol.compare(0, 18, "MOUNT_MINING_LASER") == 0)
+        {
+            symbols.push_back(mount.symbol);
+        }
+    }
+    if (symbols.empty())
+    {
+        return "NONE";
+    }
+    std::sort(symbols.begin(), symbols.end());
+
+    std::string key = symbols[0];
+    for (size_t i = 1; i < symbols.size(); i++)
+    {
+        key += "+" + symbols[i];
+    }
+    return key;
+}
+
+void MiningPlanner::recordYield(const std::string &waypointSymbol, const std::string &mountKey, const schema::Yield &yield, int cooldownSeconds)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    YieldStats &entry = stats[waypointSymbol][mountKey];
+    entry.extractions++;
+    entry.units += yield.units;
+    entry.cooldownSeconds += std::max(1, cooldownSeconds);
+    entry.unitsBySymbol[yield.symbol] += yield.units;
+}
+
+std::string MiningPlanner::assign(const schema::Ship &ship)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const std::string &current = ship.nav.waypointSymbol;
+    if (asteroidFields.empty())
+    {
+        return current;
+    }
+
+    // unexplored fields are scored as if they were as good as the best one measured so far
+    const std::string key = mountKey(ship);
+    MiningRate bestKnown;
+    bool found = false;
+    for (auto &field : stats)
+    {
+        auto entry = field.second.find(key);
+        if (entry == field.second.end() || entry->second.extractions < minSamples)
+        {
+            continue;
+        }
+        MiningRate rate = miningRate(entry->second);
+        if (!found || rate.valuePerSecond > bestKnown.valuePerSecond)
+        {
+            bestKnown = rate;
+            found = true;
+        }
+    }
+
+    std::string best = asteroidFields[0];
+    double bestScore = -1;
+    double currentScore = -1;
+    for (auto &field : asteroidFields)
+    {
+        double score = expectedValuePerSecond(field, key, ship, bestKnown);
+        if (score > bestScore)
+        {
+            best = field;
+            bestScore = score;
+        }
+        if (field == current)
+        {
+            currentScore = score;
+        }
+    }
+
+    if (currentScore >= 0 && bestScore < currentScore * (1 + switchMargin))
+    {
+        return current;
+    }
+    return best;
+}
+
+MiningPlanner::MiningRate MiningPlanner::miningRate(const YieldStats &entry) const
+{
+    // units no market is known to buy are valued at the mean of the others, with no prices at all a unit is a unit
+    double pricedValue = 0;
+    int pricedUnits = 0;
+    int unpricedUnits = 0;
+    for (auto &item : entry.unitsBySymbol)
+    {
+        int price;
+        if (p_markets->bestSellPrice(item.first, price))
+        {
+            pricedValue += (double)item.second * price;
+            pricedUnits += item.second;
+        }
+        else
+        {
+            unpricedUnits += item.second;
+        }
+    }
+    double meanPrice = pricedUnits > 0 ? pricedValue / pricedUnits : 1;
+
+    MiningRate rate;
+    rate.valuePerSecond = (pricedValue + unpricedUnits * meanPrice) / entry.cooldownSeconds;
+    rate.unitsPerSecond = (double)entry.units / entry.cooldownSeconds;
+    return rate;
+}
+
+double MiningPlanner::expectedValuePerSecond(const std::string &field, const std::string &key, const schema::Ship &ship, const MiningRate &bestKnown) const
+{
+    MiningRate rate = bestKnown;
+    rate.valuePerSecond *= 1 + explorationBonus;
+    auto waypoint = stats.find(field);
+    if (waypoint != stats.end())
+    {
+        auto entry = waypoint->second.find(key);
+        if (entry != waypoint->second.end() && entry->second.extractions >= minSamples)
+        {
+            rate = miningRate(entry->second);
+        }
+    }
+    if (rate.unitsPerSecond <= 0)
+    {
+        return 0;
+    }
+
+    // one trip is paid for with one hold of ore
+    int room = std::max(1, ship.cargo.capacity - ship.cargo.units);
+    double miningSeconds = room / rate.unitsPerSecond;
+    double travel = travelSeconds(ship.nav.waypointSymbol, field);
+    return rate.valuePerSecond * miningSeconds / (miningSeconds + travel);
+}
+
+double MiningPlanner::travelSeconds(const std::string &from, const std::string &to) const
+{
+    if (from == to)
+    {
+        return 0;
+    }
+    double distance;
+    if (!p_waypoints->distance(from, to, distance))
+    {
+        return unknownTravelSeconds;
+    }
+    return WaypointMap::travelSeconds(distance, shipSpeed);
+}
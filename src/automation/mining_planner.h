@@ -0,0 +1,67 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../data_layer/schema.h"
+#include "market_cache.h"
+#include "waypoint_map.h"
+
+namespace automation
+{
+    /* Chooses which asteroid field a ship should mine. Every extraction is recorded against
+    the waypoint and the ship's set of mining mounts, since a field that is rich for one
+    laser can be poor for another. Yields are valued at the best price any market pays,
+    so the ranking follows the market rather than the raw unit count.
+
+    A field is scored by the value of filling the cargo hold there, divided by the time to
+    fly over and to sit out every extraction cooldown. Fields with too few samples borrow
+    the best rate seen anywhere plus an exploration bonus. The bonus pays for a trip of up to
+    about a third of the time it takes to fill the hold, so every field within that reach is
+    tried before it can be written off.
+
+    Shared by every ship of the fleet, all calls are thread safe.
+    */
+    class MiningPlanner
+    {
+    public:
+        MiningPlanner(const std::vector<std::string> &asteroidFields, const WaypointMap &waypoints, const MarketCache &markets, int shipSpeed = 30);
+
+        static std::string mountKey(const schema::Ship &ship);
+
+        void recordYield(const std::string &waypointSymbol, const std::string &mountKey, const schema::Yield &yield, int cooldownSeconds);
+        // the field to mine next, the current waypoint is kept unless another one is clearly better
+        std::string assign(const schema::Ship &ship);
+
+    private:
+        struct YieldStats
+        {
+            int extractions = 0;
+            int units = 0;
+            long cooldownSeconds = 0;
+            std::unordered_map<std::string, int> unitsBySymbol;
+        };
+
+        // while mining, with the cooldowns included
+        struct MiningRate
+        {
+            double valuePerSecond = 1;
+            double unitsPerSecond = 1;
+        };
+
+        MiningRate miningRate(const YieldStats &entry) const;
+        double expectedValuePerSecond(const std::string &field, const std::string &key, const schema::Ship &ship, const MiningRate &bestKnown) const;
+        double travelSeconds(const std::string &from, const std::string &to) const;
+
+        std::vector<std::string> asteroidFields;
+        const WaypointMap *p_waypoints;
+        const MarketCache *p_markets;
+        int shipSpeed;
+        // waypoint -> mount key -> stats
+        std::map<std::string, std::map<std::string, YieldStats>> stats;
+        mutable std::mutex mutex;
+    };
+}
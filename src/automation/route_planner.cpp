@@ -0,0 +1,134 @@
+#include "route_planner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+using namespace automation;
+
+// ------------------------- Parameters ---------------------------
+// dock, refuel and orbit again
+const double refuelSeconds = 3;
+// STEALTH burns as much as CRUISE and is slower, it is never the fastest choice
+const FlightMode routeModes[] = {CRUISE, BURN, DRIFT};
+// ----------------------------------------------------------------
+
+struct Label
+{
+    double seconds;
+    int fuel;
+    int node;
+    int parent;
+    FlightMode mode;
+    bool refuel;
+    int hopFuel;
+    double hopSeconds;
+};
+
+RoutePlanner::RoutePlanner(const WaypointMap &waypoints, int shipSpeed)
+    : p_waypoints(&waypoints), shipSpeed(shipSpeed)
+{
+}
+
+Route RoutePlanner::plan(const std::string &from, const std::string &to, int fuel, int fuelCapacity) const
+{
+    Route route;
+    if (from == to)
+    {
+        route.found = true;
+        return route;
+    }
+
+    std::vector<WaypointMap::Node> nodes = p_waypoints->getNodes();
+    std::unordered_map<std::string, int> index;
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        index[nodes[i].symbol] = (int)i;
+    }
+    if (index.count(from) == 0 || index.count(to) == 0)
+    {
+        return route;
+    }
+    // ships without a tank do not use fuel at all
+    bool usesFuel = fuelCapacity > 0;
+    int target = index[to];
+
+    std::vector<Label> labels;
+    std::vector<std::vector<int>> settled(nodes.size());
+    typedef std::pair<double, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    auto dominated = [&labels, &settled](int node, double seconds, int fuel)
+    {
+        for (int other : settled[node])
+        {
+            if (labels[other].seconds <= seconds && labels[other].fuel >= fuel)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    labels.push_back(Label{0, fuel, index[from], -1, CRUISE, false, 0, 0});
+    queue.push(Entry(0, 0));
+    while (!queue.empty())
+    {
+        int current = queue.top().second;
+        queue.pop();
+        Label label = labels[current];
+        if (dominated(label.node, label.seconds, label.fuel))
+        {
+            continue;
+        }
+        settled[label.node].push_back(current);
+
+        if (label.node == target)
+        {
+            for (int i = current; labels[i].parent >= 0; i = labels[i].parent)
+            {
+                const Label &hop = labels[i];
+                route.hops.push_back(RouteHop{nodes[hop.node].symbol, hop.mode, hop.refuel, hop.hopFuel, hop.hopSeconds});
+            }
+            std::reverse(route.hops.begin(), route.hops.end());
+            route.seconds = label.seconds;
+            route.found = true;
+            return route;
+        }
+
+        const WaypointMap::Node &here = nodes[label.node];
+        bool canRefuel = usesFuel && here.fuelStation && label.fuel < fuelCapacity;
+        for (int refuel = 0; refuel <= (canRefuel ? 1 : 0); refuel++)
+        {
+            int tank = refuel ? fuelCapacity : label.fuel;
+            double departure = label.seconds + (refuel ? refuelSeconds : 0);
+            for (size_t next = 0; next < nodes.size(); next++)
+            {
+                if ((int)next == label.node)
+                {
+                    continue;
+                }
+                double distance = std::hypot(nodes[next].x - here.x, nodes[next].y - here.y);
+                for (FlightMode mode : routeModes)
+                {
+                    int cost = usesFuel ? WaypointMap::fuelCost(distance, mode) : 0;
+                    if (cost > tank)
+                    {
+                        continue;
+                    }
+                    double seconds = WaypointMap::travelSeconds(distance, shipSpeed, mode);
+                    double arrival = departure + seconds;
+                    if (dominated((int)next, arrival, tank - cost))
+                    {
+                        continue;
+                    }
+                    labels.push_back(Label{arrival, tank - cost, (int)next, current, mode, refuel == 1, cost, seconds});
+                    queue.push(Entry(arrival, (int)labels.size() - 1));
+                }
+            }
+        }
+    }
+    return route;
+}
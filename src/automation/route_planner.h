@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "waypoint_map.h"
+
+namespace automation
+{
+    struct RouteHop
+    {
+        std::string waypointSymbol;
+        FlightMode flightMode;
+        // fill the tank where the hop starts
+        bool refuel;
+        int fuel;
+        double seconds;
+    };
+
+    struct Route
+    {
+        bool found = false;
+        std::vector<RouteHop> hops;
+        double seconds = 0;
+    };
+
+    /* Fastest route between two waypoints on the fuel the ship carries. A Dijkstra over
+    (waypoint, fuel left) labels: a label is dropped when another one at the same waypoint
+    arrived no later with no less fuel. Every pair of waypoints is one hop in any flight mode,
+    and a ship at a fuel station may fill up before leaving. DRIFT costs a single unit of fuel,
+    so unless the tank is empty every known waypoint can be reached, only slowly.
+    */
+    class RoutePlanner
+    {
+    public:
+        RoutePlanner(const WaypointMap &waypoints, int shipSpeed = 30);
+
+        Route plan(const std::string &from, const std::string &to, int fuel, int fuelCapacity) const;
+
+    private:
+        const WaypointMap *p_waypoints;
+        int shipSpeed;
+    };
+}
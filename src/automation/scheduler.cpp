@@ -0,0 +1,187 @@
+#include "spdlog/spdlog.h"
+#include <fmt/core.h>
+
+#include "scheduler.h"
+
+using namespace automation;
+
+Scheduler::Scheduler(int workerCount)
+    : workerCount(workerCount), running(false)
+{
+}
+
+void Scheduler::add(Job job, std::chrono::milliseconds delay)
+{
+    addJob(std::move(job), delay, nullptr);
+}
+
+void Scheduler::add(ship::ShipAutomator &shipAutomator)
+{
+    addJob([&shipAutomator]()
+           { return shipAutomator.step(); },
+           std::chrono::milliseconds(0), &shipAutomator);
+}
+
+void Scheduler::run()
+{
+    spdlog::info(fmt::format("Scheduler: Starting {} workers...", workerCount));
+    running = true;
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < workerCount; i++)
+    {
+        workers.emplace_back(&Scheduler::workerLoop, this);
+    }
+    timerLoop();
+
+    {
+        std::lock_guard<std::mutex> lock(readyMutex);
+        readyJobs.clear();
+    }
+    jobReady.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    spdlog::info("Scheduler: Stopped.");
+}
+
+void Scheduler::stop()
+{
+    {
+        // taking the lock makes sure the timer thread is either waiting or will see the flag
+        std::lock_guard<std::mutex> lock(tableMutex);
+        running = false;
+    }
+    tableChanged.notify_all();
+}
+
+std::string Scheduler::describeFleet()
+{
+    std::vector<int> counts(ship::STATUSES, 0);
+    {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        table.countStatuses(counts);
+    }
+    std::string description;
+    for (int status = 0; status < ship::STATUSES; status++)
+    {
+        if (counts[status] == 0)
+        {
+            continue;
+        }
+        description += fmt::format("{}{} {}", description.empty() ? "" : ", ", ship::statusName(status), counts[status]);
+    }
+    return description.empty() ? "no ships" : description;
+}
+
+void Scheduler::addJob(Job job, std::chrono::milliseconds delay, ship::ShipAutomator *p_shipAutomator)
+{
+    std::size_t id;
+    {
+        // both locks at once, so that job ids and table rows are handed out in the same order
+        std::lock_guard<std::mutex> lock(tableMutex);
+        std::lock_guard<std::mutex> readyLock(readyMutex);
+        jobs.emplace_back(new Job(std::move(job)));
+        shipAutomators.push_back(p_shipAutomator);
+        id = table.addRow();
+    }
+    reschedule(id, delay, p_shipAutomator);
+}
+
+void Scheduler::timerLoop()
+{
+    std::vector<std::size_t> due;
+    std::unique_lock<std::mutex> lock(tableMutex);
+    while (running)
+    {
+        table.collectDue(FleetTable::Clock::now(), due);
+        if (!due.empty())
+        {
+            {
+                std::lock_guard<std::mutex> readyLock(readyMutex);
+                readyJobs.insert(readyJobs.end(), due.begin(), due.end());
+            }
+            due.clear();
+            jobReady.notify_all();
+        }
+
+        // sleeps until the earliest deadline rather than ticking, a job coming back earlier wakes it up
+        FleetTable::Clock::time_point nextDue = table.nextDue();
+        if (nextDue == FleetTable::Clock::time_point::max())
+        {
+            tableChanged.wait(lock);
+        }
+        else
+        {
+            tableChanged.wait_until(lock, nextDue);
+        }
+    }
+}
+
+void Scheduler::workerLoop()
+{
+    while (true)
+    {
+        std::size_t id;
+        Job *job;
+        ship::ShipAutomator *p_shipAutomator;
+        {
+            std::unique_lock<std::mutex> lock(readyMutex);
+            jobReady.wait(lock, [this]
+                          { return !readyJobs.empty() || !running; });
+            if (readyJobs.empty())
+            {
+                return;
+            }
+            id = readyJobs.front();
+            readyJobs.pop_front();
+            job = jobs[id].get();
+            p_shipAutomator = shipAutomators[id];
+        }
+
+        std::chrono::milliseconds delay;
+        try
+        {
+            delay = (*job)();
+        }
+        catch (std::exception &e)
+        {
+            // keep the rest of the fleet running, the job gets another go shortly
+            spdlog::error(fmt::format("Scheduler: Job {} failed with {}", id, e.what()));
+            delay = std::chrono::seconds(1);
+        }
+        reschedule(id, delay, p_shipAutomator);
+    }
+}
+
+void Scheduler::reschedule(std::size_t id, std::chrono::milliseconds delay, ship::ShipAutomator *p_shipAutomator)
+{
+    // the symbols are interned before taking the lock the timer thread waits on
+    std::uint32_t shipId = 0;
+    std::uint32_t waypointId = 0;
+    std::uint32_t targetId = 0;
+    if (p_shipAutomator != nullptr)
+    {
+        shipId = symbols.intern(p_shipAutomator->getShipSymbol());
+        waypointId = symbols.intern(p_shipAutomator->getWaypointSymbol());
+        targetId = symbols.intern(p_shipAutomator->getTargetWaypoint());
+    }
+
+    FleetTable::Clock::time_point due = FleetTable::Clock::now() + delay;
+    bool earliest;
+    {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        if (p_shipAutomator != nullptr)
+        {
+            table.setShip(id, shipId, (std::uint8_t)p_shipAutomator->getStatus(), waypointId, targetId);
+        }
+        earliest = due < table.nextDue();
+        table.setWake(id, due);
+    }
+    // the timer thread only needs to know if it is sleeping past this job
+    if (earliest)
+    {
+        tableChanged.notify_one();
+    }
+}
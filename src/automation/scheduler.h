@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fleet_table.h"
+#include "ship_auto.h"
+
+namespace automation
+{
+    class Scheduler
+    {
+    public:
+        // a job runs one step and returns how long to wait before it should run again
+        typedef std::function<std::chrono::milliseconds()> Job;
+
+        Scheduler(int workerCount);
+        void add(Job job, std::chrono::milliseconds delay = std::chrono::milliseconds(0));
+        void add(ship::ShipAutomator &shipAutomator);
+        void run();
+        void stop();
+        // ships per status as of their last step, e.g. "TO_MINE 12, FULL 3"
+        std::string describeFleet();
+
+    private:
+        void addJob(Job job, std::chrono::milliseconds delay, ship::ShipAutomator *p_shipAutomator);
+        void timerLoop();
+        void workerLoop();
+        void reschedule(std::size_t id, std::chrono::milliseconds delay, ship::ShipAutomator *p_shipAutomator);
+
+        int workerCount;
+        std::atomic<bool> running;
+        std::vector<std::unique_ptr<Job>> jobs;
+        // by job id, nullptr for jobs that are not a ship
+        std::vector<ship::ShipAutomator *> shipAutomators;
+        std::deque<std::size_t> readyJobs;
+        std::mutex readyMutex;
+        std::condition_variable jobReady;
+        // one row per job, the row of a job is its id
+        FleetTable table;
+        SymbolTable symbols;
+        std::mutex tableMutex;
+        std::condition_variable tableChanged;
+    };
+}
@@ -0,0 +1,72 @@
+#include "sell_planner.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace automation;
+
+SellPlanner::SellPlanner(const MarketCache &markets, const WaypointMap &waypoints, int shipSpeed)
+    : p_markets(&markets), p_waypoints(&waypoints), shipSpeed(shipSpeed)
+{
+}
+
+SellPlan SellPlanner::plan(const schema::Ship &ship, const std::unordered_set<std::string> &notForSale, std::chrono::seconds holdSeconds) const
+{
+    const std::string &current = ship.nav.waypointSymbol;
+    std::unordered_map<std::string, MarketPrice> localPrices = p_markets->getPrices(current);
+
+    SellPlan best;
+    best.waypointSymbol = current;
+    bool found = false;
+    for (auto &market : p_markets->getMarkets())
+    {
+        std::unordered_map<std::string, MarketPrice> prices = market == current ? localPrices : p_markets->getPrices(market);
+        double credits = 0;
+        for (auto &item : ship.cargo.inventory)
+        {
+            auto price = prices.find(item.symbol);
+            if (notForSale.count(item.symbol) > 0 || price == prices.end())
+            {
+                continue;
+            }
+            credits += (double)item.units * price->second.sellPrice;
+        }
+        if (credits <= 0)
+        {
+            continue;
+        }
+
+        double seconds = std::max(1.0, (double)holdSeconds.count());
+        if (market != current)
+        {
+            double distance;
+            if (!p_waypoints->distance(current, market, distance))
+            {
+                continue;
+            }
+            // out and back again, refuelling at the market if it sells fuel
+            int fuel = WaypointMap::fuelCost(distance);
+            auto marketFuel = prices.find("FUEL");
+            bool canRefuel = marketFuel != prices.end() && marketFuel->second.purchasePrice > 0;
+            if (fuel > ship.fuel.current || (!canRefuel && 2 * fuel > ship.fuel.current))
+            {
+                continue;
+            }
+            auto localFuel = localPrices.find("FUEL");
+            int fuelPrice = canRefuel ? marketFuel->second.purchasePrice : (localFuel != localPrices.end() ? localFuel->second.purchasePrice : 0);
+            // a unit of fuel bought at the market fills 100 units of the tank
+            credits -= std::ceil(2.0 * fuel / 100) * fuelPrice;
+            seconds += 2 * WaypointMap::travelSeconds(distance, shipSpeed);
+        }
+
+        double creditsPerSecond = credits / seconds;
+        if (!found || creditsPerSecond > best.creditsPerSecond)
+        {
+            best.waypointSymbol = market;
+            best.credits = credits;
+            best.creditsPerSecond = creditsPerSecond;
+            found = true;
+        }
+    }
+    return best;
+}
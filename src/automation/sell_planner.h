@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <unordered_set>
+
+#include "../data_layer/schema.h"
+#include "market_cache.h"
+#include "waypoint_map.h"
+
+namespace automation
+{
+    struct SellPlan
+    {
+        std::string waypointSymbol;
+        // for the goods that market buys, less the fuel for the round trip
+        double credits = 0;
+        double creditsPerSecond = 0;
+    };
+
+    /* Decides where a full hold is sold. Every market with fresh prices is scored by the credits
+    the cargo fetches there, less the fuel to fly there and back, over the whole cycle: the time
+    it took to fill the hold plus the round trip. Selling where the ship already is costs no
+    travel, so a detour only wins when the better prices pay for the time away from mining.
+    Markets the ship cannot reach on the fuel it carries, or cannot leave again, are skipped.
+    */
+    class SellPlanner
+    {
+    public:
+        SellPlanner(const MarketCache &markets, const WaypointMap &waypoints, int shipSpeed = 30);
+
+        SellPlan plan(const schema::Ship &ship, const std::unordered_set<std::string> &notForSale, std::chrono::seconds holdSeconds) const;
+
+    private:
+        const MarketCache *p_markets;
+        const WaypointMap *p_waypoints;
+        int shipSpeed;
+    };
+}
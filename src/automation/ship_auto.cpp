@@ -1,106 +1,270 @@
+#include <algorithm>
 #include <ctime>
 #include <chrono>
+#include <exception>
+#include <mutex>
 #include <thread>
 #include <unordered_set>
+#include <vector>
 
 #include "spdlog/spdlog.h"
 #include <fmt/core.h>
 
 #include "ship_auto.h"
 #include "../data_layer/error.h"
+#include "../metrics/metrics.h"
 
 using namespace schema;
 using namespace automation::ship;
 
 // ----------------------------------------------------------------
-// Hardcoded constants for the time being
-const std::string AsteroidFieldWaypoint = "X1-VS75-67965Z";
-const std::string contractItem = "PLATINUM_ORE";
-const std::string contractWaypoint = "X1-VS75-70500X";
-const std::string contractID = "clhw9qowb0139s60dm28j6y4p";
-const std::unordered_set<std::string> notForSale = {"ANTIMATTER", contractItem};
+// Hardcoded constants for the time being, contract goods are kept on top of these
+const std::unordered_set<std::string> notForSale = {"ANTIMATTER"};
+const std::chrono::seconds cargoRevalidateInterval(600);
 // ----------------------------------------------------------------
 
-ShipAutomator::ShipAutomator(schema::Ship &ship, dal::DataAccessLayer &DALInstance)
+// indexed by Status, for the dwell time metrics
+const std::vector<std::string> STATUS_NAMES = {
+    "TO_MINE", "FULL", "IN_ORBIT", "IN_DOCK", "TO_SELL", "TO_NAVIGATE", "TO_DELIVER", "TEMP_IN_TRANSIT", "TEMP_ON_EXTRACT_CD"};
+std::once_flag statusNamesDescribed;
+
+std::string automation::ship::statusName(int status)
+{
+    return status >= 0 && status < STATUSES ? STATUS_NAMES[status] : "UNKNOWN";
+}
+
+ShipAutomator::ShipAutomator(schema::Ship &ship, dal::DataAccessLayer &DALInstance, Fleet &fleet)
+    : state(ship, cargoRevalidateInterval, DALInstance.getServerClock()), logger(ship.symbol)
 {
     p_ship = &ship;
     p_DALInstance = &DALInstance;
+    p_fleet = &fleet;
+    mountKey = MiningPlanner::mountKey(ship);
+    p_fleet->waypoints.add(ship.nav.route.departure);
+    p_fleet->waypoints.add(ship.nav.route.destination);
     status = TO_MINE;
     toDeliver = false;
+    toSell = false;
     targetWaypoint = "";
+    wakeDelay = std::chrono::milliseconds(0);
+    statusSince = std::chrono::steady_clock::now();
+    holdStartedAt = statusSince;
+    publishedAt = statusSince;
+    p_fleet->ships.publish(ship, publishedAt);
+    journaledCooldown = state.getCooldownExpiry();
+
+    ShipRecord record;
+    if (p_fleet->journal != nullptr && p_fleet->journal->find(ship.symbol, record))
+    {
+        restore(record);
+    }
+
+    std::call_once(statusNamesDescribed, []()
+                   { metrics::registry().describeStates(STATUS_NAMES); });
 }
 
 void ShipAutomator::start()
 {
-    log("Starting ship automator...");
+    logger.info("Starting ship automator...");
 
     while (true)
     {
-        switch (status)
+        std::this_thread::sleep_for(step());
+    }
+}
+
+std::chrono::milliseconds ShipAutomator::step()
+{
+    // run a single transition of the state machine and report when the ship wants to act next
+    wakeDelay = std::chrono::milliseconds(0);
+    Status previousStatus = status;
+    adoptRefreshedState();
+
+    // every call would fail with in transit, so sleep until the known arrival instead
+    if (state.isInTransit())
+    {
+        yieldUntil(state.getArrival());
+        return wakeDelay;
+    }
+
+    switch (status)
+    {
+    case TO_MINE:
+        if (orbit())
+        {
+            status = IN_ORBIT;
+        }
+        break;
+    case IN_ORBIT:
+        if (state.isOnCooldown())
+        {
+            yieldUntil(state.getCooldownExpiry());
+            break;
+        }
+        if (mine())
         {
-        case TO_MINE:
-            if (orbit())
+            status = FULL;
+        }
+        break;
+    case TO_NAVIGATE:
+        if (navigate())
+        {
+            targetWaypoint = "";
+            if (toDeliver)
             {
-                status = IN_ORBIT;
+                status = TO_DELIVER;
             }
-            break;
-        case IN_ORBIT:
-            if (mine())
+            else if (toSell)
             {
+                toSell = false;
                 status = FULL;
             }
-            break;
-        case TO_NAVIGATE:
-            if (navigate())
+            else
             {
-                targetWaypoint = "";
-                if (toDeliver)
-                {
-                    status = TO_DELIVER;
-                }
-                else
-                {
-                    status = TO_MINE;
-                }
+                status = TO_MINE;
             }
+        }
+        break;
+    case TO_DELIVER:
+        if (!dock())
+        {
+            yieldFor(1);
             break;
-        case TO_DELIVER:
-            while (!dock())
-            {
-                sleep(1);
-            }
-            if (deliverContract())
-            {
-                setTargetWaypoint(AsteroidFieldWaypoint);
-            }
+        }
+        if (deliverContract())
+        {
+            setMiningWaypoint();
+        }
+        break;
+    case FULL:
+        if (!planSale())
+        {
             break;
-        case FULL:
-            if (dock())
+        }
+        if (dock())
+        {
+            status = TO_SELL;
+        }
+        break;
+    case TO_SELL:
+        if (sell())
+        {
+            if (toDeliver)
             {
-                status = TO_SELL;
+                setTargetWaypoint(deliveries.front().destinationSymbol);
             }
-            break;
-        case TO_SELL:
-            if (sell())
+            else
             {
-                if (toDeliver)
-                {
-                    setTargetWaypoint(contractWaypoint);
-                }
-                else
-                {
-                    status = TO_MINE;
-                }
+                setMiningWaypoint();
             }
-            break;
-        case TEMP_IN_TRANSIT:
-            status = TO_MINE;
-            break;
-        case TEMP_ON_EXTRACT_CD:
-            status = TO_MINE;
-            break;
         }
+        break;
+    case TEMP_IN_TRANSIT:
+        status = TO_MINE;
+        break;
+    case TEMP_ON_EXTRACT_CD:
+        status = TO_MINE;
+        break;
+    }
+
+    if (status != previousStatus)
+    {
+        auto now = std::chrono::steady_clock::now();
+        metrics::recordStateDwell(previousStatus, std::chrono::duration_cast<std::chrono::microseconds>(now - statusSince));
+        statusSince = now;
     }
+    publishedAt = std::chrono::steady_clock::now();
+    p_fleet->ships.publish(*p_ship, publishedAt);
+    journal();
+    return wakeDelay;
+}
+
+void ShipAutomator::adoptRefreshedState()
+{
+    // a listing asked for after the ship last acted is at least as new as what the ship knows
+    ShipSnapshot latest = p_fleet->ships.get(p_ship->symbol);
+    if (latest.ship == nullptr || latest.since <= publishedAt)
+    {
+        return;
+    }
+    state.applyNav(latest.ship->nav);
+    p_ship->fuel = latest.ship->fuel;
+    state.syncCargo(latest.ship->cargo);
+    publishedAt = latest.since;
+}
+
+void ShipAutomator::restore(const ShipRecord &record)
+{
+    // the listing already told where the ship is, the record adds what it was doing there
+    toDeliver = record.toDeliver;
+    toSell = record.toSell;
+    targetWaypoint = record.targetWaypoint;
+    deliveries = record.deliveries;
+    for (auto &delivery : deliveries)
+    {
+        p_fleet->contracts.reserve(delivery);
+    }
+    status = record.status >= TO_MINE && record.status <= TEMP_ON_EXTRACT_CD ? (Status)record.status : TO_MINE;
+    // states that take a nav status for granted start from one that sets it up
+    if (status == IN_ORBIT || status == IN_DOCK || (status == TO_NAVIGATE && targetWaypoint.empty()))
+    {
+        status = TO_MINE;
+    }
+    else if (status == TO_SELL && state.getNavStatus() != "DOCKED")
+    {
+        status = FULL;
+    }
+
+    auto remaining = record.cooldownExpiry - std::chrono::system_clock::now();
+    if (remaining > std::chrono::system_clock::duration::zero())
+    {
+        state.setCooldown(std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(remaining));
+    }
+    journaled = record;
+    journaledCooldown = state.getCooldownExpiry();
+    logger.info("Restored {} with {} deliveries, target {}.", STATUS_NAMES[status], deliveries.size(), targetWaypoint.empty() ? "none" : targetWaypoint);
+}
+
+void ShipAutomator::journal()
+{
+    // only changes are written, most steps leave the record as it was
+    if (p_fleet->journal == nullptr)
+    {
+        return;
+    }
+    ShipRecord record;
+    record.shipSymbol = p_ship->symbol;
+    record.status = status;
+    record.toDeliver = toDeliver;
+    record.toSell = toSell;
+    record.targetWaypoint = targetWaypoint;
+    record.deliveries = deliveries;
+    auto cooldown = state.getCooldownExpiry();
+    if (cooldown == journaledCooldown)
+    {
+        record.cooldownExpiry = journaled.cooldownExpiry;
+    }
+    else
+    {
+        record.cooldownExpiry = std::chrono::system_clock::now() +
+                                std::chrono::duration_cast<std::chrono::system_clock::duration>(cooldown - std::chrono::steady_clock::now());
+    }
+    if (record == journaled)
+    {
+        return;
+    }
+    // the journal is best effort, a failure must not undo a step that already happened
+    try
+    {
+        p_fleet->journal->append(record);
+    }
+    catch (const std::exception &e)
+    {
+        logger.warn("Could not journal the state: {}", e.what());
+        return;
+    }
+    journaled = record;
+    journaledCooldown = cooldown;
 }
 
 std::string ShipAutomator::getShipSymbol()
@@ -108,195 +272,405 @@ std::string ShipAutomator::getShipSymbol()
     return p_ship->symbol;
 }
 
-void ShipAutomator::updateCargo(Cargo cargo)
+Status ShipAutomator::getStatus()
+{
+    return status;
+}
+
+std::string ShipAutomator::getWaypointSymbol()
 {
-    p_ship->cargo = cargo;
+    return p_ship->nav.waypointSymbol;
 }
 
-void ShipAutomator::updateCargo()
+std::string ShipAutomator::getTargetWaypoint()
 {
-    // fetch current cargo information from the database
-    p_ship->cargo = p_DALInstance->getShipCargo(p_ship->symbol);
+    return targetWaypoint;
+}
+
+void ShipAutomator::revalidateCargo()
+{
+    // fetch current cargo information from the database, only if the local state cannot be trusted
+    if (state.isCargoStale())
+    {
+        state.syncCargo(p_DALInstance->getShipCargo(p_ship->symbol, dal::BACKGROUND));
+    }
 }
 
 bool ShipAutomator::mine()
 {
     // return true if the cargo is full
-    log("Mining...");
+    logger.info("Mining...");
 
-    try
+    dal::Result<ExtractResponse> result = p_DALInstance->tryMine(p_ship->symbol, dal::CRITICAL);
+    if (!result.ok())
     {
-        ExtractResponse response = p_DALInstance->mine(p_ship->symbol);
-        log(fmt::format("Yield = {}, CD = {}, Cargo = {}", response.yield.printStat(), response.cooldownSeconds, response.cargo.printStat()));
-
-        updateCargo(response.cargo);
-        if (p_ship->cargo.isFull())
+        const error::GameError &e = result.error();
+        switch (e.code)
         {
+        case error::ErrorCode::EXTRACT_COOLDOWN:
+            handleExtractCooldownError(e);
+            break;
+        case error::ErrorCode::IN_TRANSIT:
+            handleInTransitError(e);
+            break;
+        case error::ErrorCode::FULL_CARGO:
+            handleFullCargoError(e);
             return true;
+        case error::ErrorCode::EXTRACT_INVALID_WAYPOINT:
+            handleExtractInvalidWaypointError(e);
+            break;
+        default:
+            e.raise();
         }
-        else
-        {
-            Status prevStatus = status;
-            status = TEMP_ON_EXTRACT_CD;
-            sleep(response.cooldownSeconds);
-            status = prevStatus;
-        }
+        return false;
     }
-    catch (error::ExtractCooldownException &e)
+
+    ExtractResponse &response = result.value();
+    logger.info("Yield = {}, CD = {}, Cargo = {}", response.yield.printStat(), response.cooldownSeconds, response.cargo.printStat());
+    state.applyCargo(response.cargo, response.yield.units);
+    state.setCooldown(response.cooldownExpiration, std::chrono::seconds(response.cooldownSeconds));
+    p_fleet->miningPlanner.recordYield(p_ship->nav.waypointSymbol, mountKey, response.yield, response.cooldownSeconds);
+    if (p_ship->cargo.isFull())
     {
-        handleExtractCooldownError(e);
+        return true;
     }
-    catch (error::InTransitException &e)
+    yieldUntil(state.getCooldownExpiry());
+    return false;
+}
+
+bool ShipAutomator::planSale()
+{
+    // return true to sell where the ship is, otherwise it is sent on to a better market first
+    p_fleet->contracts.refresh(*p_DALInstance);
+    refreshMarket();
+    auto holdSeconds = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - holdStartedAt);
+    SellPlan plan = p_fleet->sellPlanner.plan(*p_ship, getKeptGoods(), holdSeconds);
+    if (plan.waypointSymbol == p_ship->nav.waypointSymbol)
+    {
+        return true;
+    }
+
+    logger.info("Selling at {} instead, expecting {:.0f} credits.", plan.waypointSymbol, plan.credits);
+    toSell = true;
+    setTargetWaypoint(plan.waypointSymbol);
+    return false;
+}
+
+void ShipAutomator::refreshMarket()
+{
+    const std::string &waypointSymbol = p_ship->nav.waypointSymbol;
+    if (p_fleet->markets.isFresh(waypointSymbol))
     {
-        handleInTransitError(e);
+        return;
     }
-    catch (error::FullCargoException &e)
+
+    try
     {
-        handleFullCargoError(e);
-        return true;
+        p_fleet->updateMarket(p_DALInstance->getMarket(p_ship->nav.systemSymbol, waypointSymbol));
     }
-    catch (error::ExtractInvalidWaypointException &e)
+    catch (const error::BaseException &e)
     {
-        handleExtractInvalidWaypointError(e);
+        // not every waypoint has a market, the cached prices have to do
+        logger.warn("No market data at {}: {}", waypointSymbol, e.what());
     }
-    return false;
 }
 
 bool ShipAutomator::sell()
 {
-    log("Selling...");
+    logger.info("Selling...");
 
-    try
+    revalidateCargo();
+    // a market that is known not to buy a good would only refuse it, the good waits for one that does
+    std::unordered_map<std::string, MarketPrice> prices = p_fleet->markets.getPrices(p_ship->nav.waypointSymbol);
+    std::unordered_set<std::string> keptGoods = getKeptGoods();
+    std::vector<dal::SellOrder> orders;
+    for (auto &item : p_ship->cargo.inventory)
     {
-        updateCargo();
-        for (auto &item : p_ship->cargo.inventory)
+        if (keptGoods.count(item.symbol) > 0)
+        {
+            logger.info("Found not for sale item {}, skipping...", item.symbol);
+            continue;
+        }
+        int bestPrice;
+        if (!prices.empty() && prices.count(item.symbol) == 0)
         {
-            if (notForSale.count(item.symbol) > 0)
+            if (p_fleet->markets.bestSellPrice(item.symbol, bestPrice))
             {
-                log(fmt::format("Found not for sale item {}, skipping...", item.symbol));
+                logger.info("{} is not traded here, keeping it...", item.symbol);
                 continue;
             }
+            // kept aboard with nowhere to go, it would fill the hold for good
+            logger.info("No known market buys {}, trying to sell it here...", item.symbol);
+        }
+        orders.push_back(dal::SellOrder{item.symbol, item.units});
+    }
 
-            SellResponse response = p_DALInstance->sell(p_ship->symbol, item.symbol, item.units);
-            log(fmt::format("Sold {}x {} for {}@{}.", response.units, response.tradeSymbol, response.totalPrice, response.pricePerUnit));
-            // updateCargo(response.cargo);  // will invalidate iterators, let's see if we need to update the cargo each time later
+    // one round trip for the whole hold, a failure is only acted on once every sale has come back
+    dal::SellBatch batch = p_DALInstance->trySellBatch(p_ship->symbol, orders, dal::CRITICAL);
+    for (auto &result : batch.results)
+    {
+        if (!result.ok())
+        {
+            continue;
         }
-        updateCargo();
+        const SellResponse &response = result.value();
+        logger.info("Sold {}x {} for {}@{}.", response.units, response.tradeSymbol, response.totalPrice, response.pricePerUnit);
+        p_fleet->markets.recordSale(response.waypointSymbol, response.tradeSymbol, response.pricePerUnit);
     }
-    catch (error::InTransitException &e)
+    if (batch.hasCargo)
     {
-        handleInTransitError(e);
-        return false;
+        state.applyCargo(batch.cargo, -batch.units);
     }
-    if (p_ship->cargo.isFull())
+
+    const error::GameError *p_gameError = batch.firstError();
+    if (batch.failure || p_gameError != nullptr)
+    {
+        state.markCargoStale();
+    }
+    if (batch.failure)
     {
-        toDeliver = true;
-    } else {
-        if (toDeliver) {
-            log("toDeliver is true but cargo is not full, this should not happen.", spdlog::level::warn);
+        std::rethrow_exception(batch.failure);
+    }
+    if (p_gameError != nullptr)
+    {
+        if (p_gameError->code != error::ErrorCode::IN_TRANSIT)
+        {
+            p_gameError->raise();
         }
-        toDeliver = false;
+        handleInTransitError(*p_gameError);
+        return false;
+    }
+    holdStartedAt = std::chrono::steady_clock::now();
+
+    // contract goods are only taken to their destination once there are enough of them for a trip
+    toDeliver = p_fleet->contracts.assign(*p_ship, deliveries);
+    if (!toDeliver && p_ship->cargo.isFull())
+    {
+        logger.warn("Cargo is still full with nothing to deliver, this should not happen.");
+        yieldFor(60);
     }
     return true;
 }
 
 bool ShipAutomator::dock()
 {
-    log("Docking...");
-    try
+    if (state.getNavStatus() == "DOCKED")
     {
-        p_DALInstance->dock(p_ship->symbol);
-        log("Docked.");
         return true;
     }
-    catch (error::InTransitException &e)
+
+    logger.info("Docking...");
+    dal::Result<bool> result = p_DALInstance->tryDock(p_ship->symbol);
+    if (result.ok())
     {
-        handleInTransitError(e);
+        logger.info("Docked.");
+        state.setNavStatus("DOCKED");
+        return true;
     }
+    if (result.error().code != error::ErrorCode::IN_TRANSIT)
+    {
+        result.error().raise();
+    }
+    handleInTransitError(result.error());
     return false;
 }
 
 bool ShipAutomator::orbit()
 {
-    log("Orbiting...");
-    try
+    if (state.getNavStatus() == "IN_ORBIT")
     {
-        p_DALInstance->orbit(p_ship->symbol);
-        log("Orbited.");
         return true;
     }
-    catch (error::InTransitException &e)
+
+    logger.info("Orbiting...");
+    dal::Result<bool> result = p_DALInstance->tryOrbit(p_ship->symbol);
+    if (result.ok())
     {
-        handleInTransitError(e);
+        logger.info("Orbited.");
+        state.setNavStatus("IN_ORBIT");
+        return true;
+    }
+    if (result.error().code != error::ErrorCode::IN_TRANSIT)
+    {
+        result.error().raise();
     }
+    handleInTransitError(result.error());
     return false;
 }
 
 bool ShipAutomator::refuel()
 {
-    log("Refueling...");
-    try
+    logger.info("Refueling...");
+    dal::Result<bool> result = p_DALInstance->tryRefuel(p_ship->symbol);
+    if (result.ok())
     {
-        p_DALInstance->refuel(p_ship->symbol);
-        log("Refueled.");
+        logger.info("Refueled.");
+        p_ship->fuel.current = p_ship->fuel.capacity;
         return true;
     }
-    catch (error::InTransitException &e)
+    if (result.error().code != error::ErrorCode::IN_TRANSIT)
     {
-        handleInTransitError(e);
+        result.error().raise();
     }
+    handleInTransitError(result.error());
     return false;
 }
 
 bool ShipAutomator::navigate()
 {
-    log(fmt::format("Navigating to {}...", targetWaypoint));
-    try
+    // return true once the ship is at targetWaypoint, one hop of the route is flown per call
+    if (route.empty())
     {
-        NavResponse response = p_DALInstance->navigate(p_ship->symbol, targetWaypoint);
-        int ETA = response.nav.route.getETA();
-        log(fmt::format("Fuel left: {}. ETA: {} seconds.", response.fuel.printStat(), ETA));
-        sleep(ETA);
-        log(fmt::format("Navgiated to {}.", targetWaypoint));
-        return true;
+        planRoute();
     }
-    catch (error::InTransitException &e)
+    RouteHop &hop = route.front();
+
+    if (hop.refuel)
     {
-        handleInTransitError(e);
+        if (!dock() || !refuel())
+        {
+            return false;
+        }
+        hop.refuel = false;
     }
-    catch (error::NavigateSameLocationException &e)
+    // ships leave from orbit, a docked ship would only be refused
+    if (!orbit())
     {
-        handleNavigateSameLocationError(e);
-        return true;
+        return false;
     }
-    catch (error::NavigateInsufficientFuelException &e)
+
+    const char *flightMode = flightModeName(hop.flightMode);
+    if (p_ship->nav.flightMode != flightMode)
     {
-        handleNavigateInsufficientFuelError(e);
+        logger.info("Switching to flight mode {}...", flightMode);
+        state.applyNav(p_DALInstance->setFlightMode(p_ship->symbol, flightMode, dal::CRITICAL));
+    }
+
+    logger.info("Navigating to {} in {}, {} hops left...", hop.waypointSymbol, flightMode, route.size());
+    dal::Result<NavResponse> result = p_DALInstance->tryNavigate(p_ship->symbol, hop.waypointSymbol, dal::CRITICAL);
+    if (!result.ok())
+    {
+        const error::GameError &e = result.error();
+        switch (e.code)
+        {
+        case error::ErrorCode::IN_TRANSIT:
+            handleInTransitError(e);
+            break;
+        case error::ErrorCode::NAVIGATE_SAME_LOCATION:
+            handleNavigateSameLocationError(e);
+            route.pop_front();
+            return route.empty();
+        case error::ErrorCode::NAVIGATE_INSUFFICIENT_FUEL:
+            // the plan was off, it is made again from a full tank
+            route.clear();
+            handleNavigateInsufficientFuelError(e);
+            break;
+        default:
+            e.raise();
+        }
+        return false;
+    }
+
+    route.pop_front();
+    NavResponse &response = result.value();
+    p_ship->fuel = response.fuel;
+    state.applyNav(response.nav);
+    p_fleet->waypoints.add(response.nav.route.departure);
+    p_fleet->waypoints.add(response.nav.route.destination);
+    logger.info("Fuel left: {}. ETA: {} ms.", response.fuel.printStat(),
+                std::chrono::duration_cast<std::chrono::milliseconds>(state.getArrival() - std::chrono::steady_clock::now()).count());
+    yieldUntil(state.getArrival());
+    return route.empty();
+}
+
+void ShipAutomator::planRoute()
+{
+    Route planned = p_fleet->routePlanner.plan(p_ship->nav.waypointSymbol, targetWaypoint, p_ship->fuel.current, p_ship->fuel.capacity);
+    if (!planned.found || planned.hops.empty())
+    {
+        // an unknown waypoint or an empty tank, a direct hop lets the server tell
+        route.push_back(RouteHop{targetWaypoint, CRUISE, false, 0, 0});
+        return;
+    }
+    route.assign(planned.hops.begin(), planned.hops.end());
+    if (route.size() > 1)
+    {
+        logger.info("Planned {} hops to {}, {:.0f} seconds.", route.size(), targetWaypoint, planned.seconds);
     }
-    return false;
 }
 
 bool ShipAutomator::deliverContract()
 {
-    log(fmt::format("Delivering contract {}...", contractID));
-    try
+    logger.info("Delivering contracts...");
+    revalidateCargo();
+    // the hold may have changed since the assignment, never offer more than is aboard
+    std::vector<dal::DeliverOrder> orders;
+    for (auto &delivery : deliveries)
     {
-        updateCargo();
+        int units = 0;
         for (auto &item : p_ship->cargo.inventory)
         {
-            if (item.symbol == contractItem)
+            if (item.symbol == delivery.tradeSymbol)
             {
-                log(fmt::format("Delivering {}x {}...", item.units, item.symbol));
-                p_DALInstance->deliverContract(contractID, p_ship->symbol, item.symbol, item.units);
-                log(fmt::format("Delivered {}x {}.", item.units, item.symbol));
-                // updateCargo(response.cargo);  // will invalidate iterators, let's see if we need to update the cargo each time later
+                units += item.units;
             }
         }
-        updateCargo();
+        orders.push_back(dal::DeliverOrder{delivery.contractId, delivery.tradeSymbol, std::min(units, delivery.units)});
+    }
+    orders.erase(std::remove_if(orders.begin(), orders.end(), [](const dal::DeliverOrder &order)
+                                { return order.units == 0; }),
+                 orders.end());
+
+    dal::DeliverBatch batch = p_DALInstance->tryDeliverBatch(p_ship->symbol, orders, dal::CRITICAL);
+    if (batch.hasCargo)
+    {
+        state.applyCargo(batch.cargo, -batch.units);
+    }
+
+    // settle whatever went through before looking at the failures
+    std::vector<DeliveryAssignment> pending;
+    for (auto &delivery : deliveries)
+    {
+        auto order = std::find_if(orders.begin(), orders.end(), [&delivery](const dal::DeliverOrder &order)
+                                  { return order.contractId == delivery.contractId && order.tradeSymbol == delivery.tradeSymbol; });
+        if (order == orders.end())
+        {
+            p_fleet->contracts.release(delivery);
+            continue;
+        }
+        const dal::Result<DeliverResponse> &result = batch.results[order - orders.begin()];
+        if (!result.ok())
+        {
+            pending.push_back(delivery);
+            continue;
+        }
+        logger.info("Delivered {}x {}.", order->units, order->tradeSymbol);
+        p_fleet->contracts.delivered(delivery, result.value().contract, *p_DALInstance);
     }
-    catch (error::InTransitException &e)
+    deliveries = pending;
+
+    const error::GameError *p_gameError = batch.firstError();
+    if (batch.failure || p_gameError != nullptr)
+    {
+        state.markCargoStale();
+    }
+    if (batch.failure || (p_gameError != nullptr && p_gameError->code != error::ErrorCode::IN_TRANSIT))
+    {
+        for (auto &delivery : deliveries)
+        {
+            p_fleet->contracts.release(delivery);
+        }
+        deliveries.clear();
+        if (batch.failure)
+        {
+            std::rethrow_exception(batch.failure);
+        }
+        p_gameError->raise();
+    }
+    if (p_gameError != nullptr)
     {
-        handleInTransitError(e);
+        // the rest is tried again on arrival
+        handleInTransitError(*p_gameError);
         return false;
     }
 
@@ -304,89 +678,86 @@ bool ShipAutomator::deliverContract()
     return true;
 }
 
+std::unordered_set<std::string> ShipAutomator::getKeptGoods()
+{
+    std::unordered_set<std::string> goods = p_fleet->contracts.getWantedGoods();
+    goods.insert(notForSale.begin(), notForSale.end());
+    return goods;
+}
+
 void ShipAutomator::setTargetWaypoint(std::string waypointSymbol)
 {
     targetWaypoint = waypointSymbol;
+    route.clear();
     status = TO_NAVIGATE;
 }
 
-void ShipAutomator::sleep(int seconds)
+void ShipAutomator::setMiningWaypoint()
 {
-    log(fmt::format("Sleeping for {} seconds...", seconds));
-    std::this_thread::sleep_for(std::chrono::seconds(seconds));
-    log(fmt::format("Waking up from sleep after {} seconds.", seconds));
+    // stay put when the planner prefers the field the ship is already at
+    std::string field = p_fleet->miningPlanner.assign(*p_ship);
+    if (field == p_ship->nav.waypointSymbol)
+    {
+        status = TO_MINE;
+        return;
+    }
+    logger.info("Moving to asteroid field {}.", field);
+    setTargetWaypoint(field);
 }
 
-void ShipAutomator::log(const std::string &message, spdlog::level::level_enum level)
+void ShipAutomator::yieldFor(int seconds)
 {
-    std::string formattedMessage = fmt::format("{}: {}", p_ship->symbol, message);
-    switch (level)
-    {
-    case spdlog::level::trace:
-        spdlog::trace(formattedMessage);
-        break;
-    case spdlog::level::debug:
-        spdlog::debug(formattedMessage);
-        break;
-    case spdlog::level::info:
-        spdlog::info(formattedMessage);
-        break;
-    case spdlog::level::warn:
-        spdlog::warn(formattedMessage);
-        break;
-    case spdlog::level::err:
-        spdlog::error(formattedMessage);
-        break;
-    case spdlog::level::critical:
-        spdlog::critical(formattedMessage);
-        break;
-    }
+    // does not block, the caller of step() resumes the ship once the delay has passed
+    logger.info("Yielding for {} seconds...", seconds);
+    wakeDelay = std::max(wakeDelay, std::chrono::milliseconds(std::chrono::seconds(seconds)));
+}
+
+void ShipAutomator::yieldUntil(std::chrono::steady_clock::time_point time)
+{
+    // rounded up, waking a moment early would only earn another error
+    auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(time - std::chrono::steady_clock::now()) + std::chrono::milliseconds(1);
+    logger.info("Yielding for {} milliseconds...", delay.count());
+    wakeDelay = std::max(wakeDelay, delay);
 }
 
-void ShipAutomator::handleInTransitError(const error::InTransitException &e)
+void ShipAutomator::handleInTransitError(const error::GameError &e)
 {
-    Status prevStatus = status;
-    log(e.what());
-    status = TEMP_IN_TRANSIT;
-    sleep(e.getSecondsToArrival());
-    status = prevStatus;
+    logger.info("{}", e.message);
+    state.setArrival(e.waitUntil, std::chrono::seconds(e.waitSeconds));
+    yieldUntil(state.getArrival());
 }
 
-void ShipAutomator::handleExtractCooldownError(const error::ExtractCooldownException &e)
+void ShipAutomator::handleExtractCooldownError(const error::GameError &e)
 {
-    Status prevStatus = status;
-    log(e.what());
-    status = TEMP_ON_EXTRACT_CD;
-    sleep(e.getCooldown());
-    status = prevStatus;
+    logger.info("{}", e.message);
+    state.setCooldown(e.waitUntil, std::chrono::seconds(e.waitSeconds));
+    yieldUntil(state.getCooldownExpiry());
 }
 
-void ShipAutomator::handleFullCargoError(const error::FullCargoException &e)
+void ShipAutomator::handleFullCargoError(const error::GameError &e)
 {
-    log(e.what());
+    logger.info("{}", e.message);
+    // the local cargo thought there was room left
+    state.markCargoStale();
 }
 
-void ShipAutomator::handleExtractInvalidWaypointError(const error::ExtractInvalidWaypointException &e)
+void ShipAutomator::handleExtractInvalidWaypointError(const error::GameError &e)
 {
-    log(e.what());
-    setTargetWaypoint(AsteroidFieldWaypoint);
+    logger.info("{}", e.message);
+    setMiningWaypoint();
 }
 
-void ShipAutomator::handleNavigateSameLocationError(const error::NavigateSameLocationException &e)
+void ShipAutomator::handleNavigateSameLocationError(const error::GameError &e)
 {
-    log(e.what());
+    logger.info("{}", e.message);
 }
 
-void ShipAutomator::handleNavigateInsufficientFuelError(const error::NavigateInsufficientFuelException &e)
+void ShipAutomator::handleNavigateInsufficientFuelError(const error::GameError &e)
 {
-    log(e.what());
+    logger.info("{}", e.message);
     // TODO no error handling here
-    while (!dock())
-    {
-        sleep(1);
-    }
-    while (!refuel())
+    if (!dock() || !refuel())
     {
-        sleep(1);
+        yieldFor(1);
     }
 }
@@ -2,9 +2,17 @@
 
 #include "spdlog/spdlog.h"
 
+#include <chrono>
+#include <deque>
+#include <unordered_set>
+#include <vector>
+
 #include "../data_layer/schema.h"
 #include "../data_layer/data_access.h"
 #include "../data_layer/error.h"
+#include "../data_layer/logging.h"
+#include "ship_state.h"
+#include "fleet.h"
 
 namespace automation
 {
@@ -22,43 +30,73 @@ namespace automation
             TEMP_IN_TRANSIT,
             TEMP_ON_EXTRACT_CD,
         };
+        const int STATUSES = TEMP_ON_EXTRACT_CD + 1;
+
+        std::string statusName(int status);
 
         class ShipAutomator
         {
         public:
-            ShipAutomator(schema::Ship &ship, dal::DataAccessLayer &DALInstance);
+            ShipAutomator(schema::Ship &ship, dal::DataAccessLayer &DALInstance, Fleet &fleet);
             void start();
+            std::chrono::milliseconds step();
             std::string getShipSymbol();
+            Status getStatus();
+            std::string getWaypointSymbol();
+            std::string getTargetWaypoint();
 
         private:
             bool mine();
             bool dock();
-            void updateCargo();
-            void updateCargo(schema::Cargo cargo);
+            void revalidateCargo();
+            void adoptRefreshedState();
+            void restore(const ShipRecord &record);
+            void journal();
             bool orbit();
+            bool planSale();
+            void refreshMarket();
             bool sell();
             bool navigate();
+            void planRoute();
             bool refuel();
             bool deliverContract();
+            std::unordered_set<std::string> getKeptGoods();
 
-            void sleep(int seconds);
-            void log(const std::string &message, spdlog::level::level_enum level = spdlog::level::info);
+            void yieldFor(int seconds);
+            void yieldUntil(std::chrono::steady_clock::time_point time);
             void setTargetWaypoint(const std::string waypointSymbol);
+            void setMiningWaypoint();
 
-            void handleInTransitError(const error::InTransitException &e);
-            void handleExtractCooldownError(const error::ExtractCooldownException &e);
-            void handleFullCargoError(const error::FullCargoException &e);
-            void handleExtractInvalidWaypointError(const error::ExtractInvalidWaypointException &e);
-            void handleNavigateSameLocationError(const error::NavigateSameLocationException &e);
-            void handleNavigateInsufficientFuelError(const error::NavigateInsufficientFuelException &e);
+            void handleInTransitError(const error::GameError &e);
+            void handleExtractCooldownError(const error::GameError &e);
+            void handleFullCargoError(const error::GameError &e);
+            void handleExtractInvalidWaypointError(const error::GameError &e);
+            void handleNavigateSameLocationError(const error::GameError &e);
+            void handleNavigateInsufficientFuelError(const error::GameError &e);
             // TODO make dock, orbit retry until successful
             // TODO use strategy class for functional state transition
             // TODO make a full set of status including sth like full_cargo_to_deliver
             schema::Ship *p_ship;
+            ShipState state;
+            logging::Logger logger;
             dal::DataAccessLayer *p_DALInstance;
+            Fleet *p_fleet;
+            std::string mountKey;
             Status status;
             bool toDeliver;
+            std::vector<DeliveryAssignment> deliveries;
+            bool toSell;
+            std::chrono::steady_clock::time_point holdStartedAt;
             std::string targetWaypoint;
+            // hops still to fly towards targetWaypoint, planned when the ship sets off
+            std::deque<RouteHop> route;
+            std::chrono::milliseconds wakeDelay;
+            std::chrono::steady_clock::time_point statusSince;
+            // when the ship last put its state into the fleet store
+            std::chrono::steady_clock::time_point publishedAt;
+            // the last record written to the journal, with the cooldown it was made from
+            ShipRecord journaled;
+            std::chrono::steady_clock::time_point journaledCooldown;
             // TODO implement a queue of planned actions using double linked list?
         };
     }
@@ -0,0 +1,351 @@
+#include "ship_journal.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace automation;
+
+namespace
+{
+    // every record starts with its payload length and checksum
+    const std::size_t HEADER_SIZE = 2 * sizeof(uint32_t);
+
+    std::system_error systemError(const std::string &what)
+    {
+        return std::system_error(errno, std::generic_category(), what);
+    }
+
+    uint32_t checksum(const char *data, std::size_t size)
+    {
+        // FNV-1a, only meant to catch torn and stale records
+        uint32_t hash = 2166136261u;
+        for (std::size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ (unsigned char)data[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    class RecordWriter
+    {
+    public:
+        template <typename T>
+        void put(T value)
+        {
+            buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+
+        void put(const std::string &value)
+        {
+            put<uint16_t>((uint16_t)value.size());
+            buffer.append(value);
+        }
+
+        std::string buffer;
+    };
+
+    class RecordReader
+    {
+    public:
+        RecordReader(const char *data, std::size_t size) : p_data(data), left(size) {}
+
+        // false once the record ends early, the value is left alone
+        template <typename T>
+        bool get(T &value)
+        {
+            if (left < sizeof(value))
+            {
+                return false;
+            }
+            std::memcpy(&value, p_data, sizeof(value));
+            p_data += sizeof(value);
+            left -= sizeof(value);
+            return true;
+        }
+
+        bool get(std::string &value)
+        {
+            uint16_t size;
+            if (!get(size) || left < size)
+            {
+                return false;
+            }
+            value.assign(p_data, size);
+            p_data += size;
+            left -= size;
+            return true;
+        }
+
+    private:
+        const char *p_data;
+        std::size_t left;
+    };
+
+    std::string encode(const ShipRecord &record)
+    {
+        RecordWriter writer;
+        writer.put(record.shipSymbol);
+        writer.put<int32_t>(record.status);
+        writer.put<uint8_t>((record.toDeliver ? 1 : 0) | (record.toSell ? 2 : 0));
+        writer.put(record.targetWaypoint);
+        writer.put<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(record.cooldownExpiry.time_since_epoch()).count());
+        writer.put<uint16_t>((uint16_t)record.deliveries.size());
+        for (auto &delivery : record.deliveries)
+        {
+            writer.put(delivery.contractId);
+            writer.put(delivery.tradeSymbol);
+            writer.put(delivery.destinationSymbol);
+            writer.put<int32_t>(delivery.units);
+        }
+
+        RecordWriter framed;
+        framed.put<uint32_t>((uint32_t)writer.buffer.size());
+        framed.put<uint32_t>(checksum(writer.buffer.data(), writer.buffer.size()));
+        framed.buffer += writer.buffer;
+        return framed.buffer;
+    }
+
+    bool decode(const char *data, std::size_t size, ShipRecord &record)
+    {
+        RecordReader reader(data, size);
+        int32_t status;
+        uint8_t flags;
+        int64_t cooldownMs;
+        uint16_t deliveryCount;
+        if (!reader.get(record.shipSymbol) || !reader.get(status) || !reader.get(flags) ||
+            !reader.get(record.targetWaypoint) || !reader.get(cooldownMs) || !reader.get(deliveryCount))
+        {
+            return false;
+        }
+        record.status = status;
+        record.toDeliver = (flags & 1) != 0;
+        record.toSell = (flags & 2) != 0;
+        record.cooldownExpiry = std::chrono::system_clock::time_point(std::chrono::milliseconds(cooldownMs));
+        record.deliveries.resize(deliveryCount);
+        for (auto &delivery : record.deliveries)
+        {
+            int32_t units;
+            if (!reader.get(delivery.contractId) || !reader.get(delivery.tradeSymbol) ||
+                !reader.get(delivery.destinationSymbol) || !reader.get(units))
+            {
+                return false;
+            }
+            delivery.units = units;
+        }
+        return true;
+    }
+}
+
+bool automation::operator==(const ShipRecord &a, const ShipRecord &b)
+{
+    if (a.shipSymbol != b.shipSymbol || a.status != b.status || a.toDeliver != b.toDeliver || a.toSell != b.toSell ||
+        a.targetWaypoint != b.targetWaypoint || a.cooldownExpiry != b.cooldownExpiry || a.deliveries.size() != b.deliveries.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.deliveries.size(); i++)
+    {
+        const DeliveryAssignment &x = a.deliveries[i];
+        const DeliveryAssignment &y = b.deliveries[i];
+        if (x.contractId != y.contractId || x.tradeSymbol != y.tradeSymbol || x.destinationSymbol != y.destinationSymbol || x.units != y.units)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+ShipJournal::ShipJournal(const std::string &directory, std::size_t capacity, std::chrono::seconds checkpointInterval)
+    : checkpointPath(directory + "/ships.checkpoint"), journalPath(directory + "/ships.journal"), capacity(capacity),
+      checkpointInterval(checkpointInterval), fd(-1), p_journal(nullptr), offset(0)
+{
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        throw systemError("Cannot create " + directory);
+    }
+    fd = open(journalPath.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        throw systemError("Cannot open " + journalPath);
+    }
+    if (ftruncate(fd, (off_t)capacity) != 0)
+    {
+        close(fd);
+        throw systemError("Cannot size " + journalPath);
+    }
+    void *mapping = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        close(fd);
+        throw systemError("Cannot map " + journalPath);
+    }
+    p_journal = static_cast<char *>(mapping);
+
+    load();
+}
+
+ShipJournal::~ShipJournal()
+{
+    // a clean shutdown leaves everything in the checkpoint
+    try
+    {
+        checkpoint();
+    }
+    catch (const std::system_error &)
+    {
+    }
+    munmap(p_journal, capacity);
+    close(fd);
+}
+
+bool ShipJournal::find(const std::string &shipSymbol, ShipRecord &record) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto entry = latest.find(shipSymbol);
+    if (entry == latest.end())
+    {
+        return false;
+    }
+    record = entry->second;
+    return true;
+}
+
+void ShipJournal::append(const ShipRecord &record)
+{
+    std::string bytes = encode(record);
+    std::lock_guard<std::mutex> lock(mutex);
+    latest[record.shipSymbol] = record;
+    // the record is in latest already, so the next checkpoint covers it
+    if (offset + bytes.size() + HEADER_SIZE > capacity)
+    {
+        return;
+    }
+
+    // the length goes in last, until then replay sees the end of the journal here
+    std::memcpy(p_journal + offset + sizeof(uint32_t), bytes.data() + sizeof(uint32_t), bytes.size() - sizeof(uint32_t));
+    std::memcpy(p_journal + offset, bytes.data(), sizeof(uint32_t));
+    offset += bytes.size();
+}
+
+void ShipJournal::checkpoint()
+{
+    std::lock_guard<std::mutex> checkpointLock(checkpointMutex);
+    std::string bytes;
+    std::size_t covered;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bytes = encodeLatest();
+        covered = offset;
+    }
+    // appends go on while the checkpoint is written, they stay in the journal after it
+    writeCheckpoint(bytes);
+    std::lock_guard<std::mutex> lock(mutex);
+    dropJournal(covered);
+}
+
+std::chrono::seconds ShipJournal::getCheckpointInterval() const
+{
+    return checkpointInterval;
+}
+
+void ShipJournal::load()
+{
+    FILE *file = std::fopen(checkpointPath.c_str(), "rb");
+    if (file != nullptr)
+    {
+        std::vector<char> data;
+        char chunk[4096];
+        std::size_t read;
+        while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+        {
+            data.insert(data.end(), chunk, chunk + read);
+        }
+        std::fclose(file);
+        replay(data.data(), data.size());
+    }
+    replay(p_journal, capacity);
+
+    // both are folded into one checkpoint, the journal starts empty
+    writeCheckpoint(encodeLatest());
+    std::memset(p_journal, 0, capacity);
+    offset = 0;
+}
+
+void ShipJournal::replay(const char *data, std::size_t size)
+{
+    std::size_t position = 0;
+    while (position + HEADER_SIZE <= size)
+    {
+        uint32_t length;
+        uint32_t expected;
+        std::memcpy(&length, data + position, sizeof(length));
+        std::memcpy(&expected, data + position + sizeof(length), sizeof(expected));
+        const char *payload = data + position + HEADER_SIZE;
+        if (length == 0 || length > size - position - HEADER_SIZE || checksum(payload, length) != expected)
+        {
+            return;
+        }
+        ShipRecord record;
+        if (decode(payload, length, record))
+        {
+            latest[record.shipSymbol] = record;
+        }
+        position += HEADER_SIZE + length;
+    }
+}
+
+std::string ShipJournal::encodeLatest() const
+{
+    std::string bytes;
+    for (auto &entry : latest)
+    {
+        bytes += encode(entry.second);
+    }
+    return bytes;
+}
+
+void ShipJournal::writeCheckpoint(const std::string &bytes)
+{
+
+    const std::string temporaryPath = checkpointPath + ".tmp";
+    int checkpointFd = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (checkpointFd < 0)
+    {
+        throw systemError("Cannot open " + temporaryPath);
+    }
+    std::size_t written = 0;
+    while (written < bytes.size())
+    {
+        ssize_t result = write(checkpointFd, bytes.data() + written, bytes.size() - written);
+        if (result < 0 && errno != EINTR)
+        {
+            close(checkpointFd);
+            throw systemError("Cannot write " + temporaryPath);
+        }
+        written += result > 0 ? (std::size_t)result : 0;
+    }
+    // the old checkpoint is only replaced by a complete new one
+    fsync(checkpointFd);
+    close(checkpointFd);
+    if (std::rename(temporaryPath.c_str(), checkpointPath.c_str()) != 0)
+    {
+        throw systemError("Cannot replace " + checkpointPath);
+    }
+}
+
+void ShipJournal::dropJournal(std::size_t covered)
+{
+    std::size_t kept = offset - covered;
+    std::memmove(p_journal, p_journal + covered, kept);
+    std::memset(p_journal + kept, 0, covered);
+    msync(p_journal, capacity, MS_ASYNC);
+    offset = kept;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "spdlog/spdlog.h"
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "contract_manager.h"
+
+namespace automation
+{
+    // what an automator needs to pick up where it left off, everything else comes with the ship listing
+    struct ShipRecord
+    {
+        std::string shipSymbol;
+        int status = 0;
+        bool toDeliver = false;
+        bool toSell = false;
+        std::string targetWaypoint;
+        // wall clock, the steady clock does not survive a restart
+        std::chrono::system_clock::time_point cooldownExpiry;
+        std::vector<DeliveryAssignment> deliveries;
+    };
+
+    bool operator==(const ShipRecord &a, const ShipRecord &b);
+
+    /* Keeps the latest ShipRecord of every ship on disk for warm restarts. Records are appended
+    to a memory mapped journal of fixed size, so a write is a copy into the page cache and survives
+    the process dying. checkpoint() writes the latest record of every ship to a checkpoint file,
+    swapped in by rename, and drops the journal records it covers. It is meant to run every
+    checkpointInterval off the ships' steps; a record that finds the journal full waits for it.
+
+    A record is [length][checksum][payload] in host byte order, and the length is written last, so
+    replay stops cleanly at a torn record. Loading reads the checkpoint, replays the journal on top
+    and compacts both. Thread safe.
+    */
+    class ShipJournal
+    {
+    public:
+        // throws std::system_error if the directory cannot be used
+        ShipJournal(const std::string &directory, std::size_t capacity = 4 << 20,
+                    std::chrono::seconds checkpointInterval = std::chrono::seconds(60));
+        ~ShipJournal();
+        ShipJournal(const ShipJournal &) = delete;
+        ShipJournal &operator=(const ShipJournal &) = delete;
+
+        bool find(const std::string &shipSymbol, ShipRecord &record) const;
+        // never touches the disk itself, so it is cheap enough for every step
+        void append(const ShipRecord &record);
+        // throws std::system_error if the checkpoint cannot be written, the journal is then kept
+        void checkpoint();
+        std::chrono::seconds getCheckpointInterval() const;
+
+    private:
+        void load();
+        void replay(const char *data, std::size_t size);
+        std::string encodeLatest() const;
+        void writeCheckpoint(const std::string &bytes);
+        // drops the first covered bytes of the journal, the records appended after them move up
+        void dropJournal(std::size_t covered);
+
+        std::string checkpointPath;
+        std::string journalPath;
+        std::size_t capacity;
+        std::chrono::seconds checkpointInterval;
+        int fd;
+        char *p_journal;
+        std::size_t offset;
+        std::unordered_map<std::string, ShipRecord> latest;
+        mutable std::mutex mutex;
+        // held across a whole checkpoint, the fsync itself runs without the mutex above
+        std::mutex checkpointMutex;
+    };
+}
@@ -0,0 +1,129 @@
+#include "spdlog/spdlog.h"
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "ship_state.h"
+
+using namespace schema;
+using namespace automation::ship;
+
+ShipState::ShipState(Ship &ship, std::chrono::seconds cargoRevalidateInterval, const dal::ServerClock &clock)
+    : p_ship(&ship), p_clock(&clock), cargoRevalidateInterval(cargoRevalidateInterval), lastCargoSync(std::chrono::steady_clock::now()), cargoStale(false),
+      arrival(std::chrono::steady_clock::now()), cooldownExpiry(std::chrono::steady_clock::now())
+{
+    applyNav(ship.nav);
+}
+
+const Cargo &ShipState::getCargo() const
+{
+    return p_ship->cargo;
+}
+
+bool ShipState::applyCargo(const Cargo &cargo, int expectedChange)
+{
+    // return false if the response does not match what the action should have done
+    int expectedUnits = p_ship->cargo.units + expectedChange;
+    p_ship->cargo = cargo;
+    if (cargo.units != expectedUnits)
+    {
+        spdlog::warn(fmt::format("{}: Cargo does not match the local state. Expected={} / Actual={}", p_ship->symbol, expectedUnits, cargo.units));
+        cargoStale = true;
+        return false;
+    }
+    return true;
+}
+
+void ShipState::syncCargo(const Cargo &cargo)
+{
+    p_ship->cargo = cargo;
+    lastCargoSync = std::chrono::steady_clock::now();
+    cargoStale = false;
+}
+
+void ShipState::markCargoStale()
+{
+    cargoStale = true;
+}
+
+bool ShipState::isCargoStale() const
+{
+    return cargoStale || std::chrono::steady_clock::now() - lastCargoSync >= cargoRevalidateInterval;
+}
+
+void ShipState::applyNav(const Nav &nav)
+{
+    p_ship->nav = nav;
+    if (nav.status == "IN_TRANSIT")
+    {
+        setArrival(nav.route.arrival, std::chrono::seconds(0));
+    }
+}
+
+void ShipState::setNavStatus(const std::string &status)
+{
+    p_ship->nav.status = status;
+}
+
+const std::string &ShipState::getNavStatus()
+{
+    // ships drop out of transit into orbit at their destination
+    if (p_ship->nav.status == "IN_TRANSIT" && !isInTransit())
+    {
+        p_ship->nav.status = "IN_ORBIT";
+    }
+    return p_ship->nav.status;
+}
+
+void ShipState::setArrival(const std::string &arrivalTime, std::chrono::seconds remaining)
+{
+    arrival = toSteady(arrivalTime, remaining);
+    p_ship->nav.status = "IN_TRANSIT";
+}
+
+std::chrono::steady_clock::time_point ShipState::getArrival() const
+{
+    return arrival;
+}
+
+bool ShipState::isInTransit() const
+{
+    return std::chrono::steady_clock::now() < arrival;
+}
+
+void ShipState::setCooldown(const std::string &expiration, std::chrono::seconds remaining)
+{
+    cooldownExpiry = toSteady(expiration, remaining);
+}
+
+void ShipState::setCooldown(std::chrono::steady_clock::time_point expiry)
+{
+    cooldownExpiry = expiry;
+}
+
+std::chrono::steady_clock::time_point ShipState::getCooldownExpiry() const
+{
+    return cooldownExpiry;
+}
+
+bool ShipState::isOnCooldown() const
+{
+    return std::chrono::steady_clock::now() < cooldownExpiry;
+}
+
+std::chrono::steady_clock::time_point ShipState::toSteady(const std::string &timestamp, std::chrono::seconds remaining) const
+{
+    if (!timestamp.empty())
+    {
+        try
+        {
+            return p_clock->toSteady(dal::ServerClock::parseTimestamp(timestamp));
+        }
+        catch (const std::invalid_argument &e)
+        {
+            spdlog::warn(fmt::format("{}: {}", p_ship->symbol, e.what()));
+        }
+    }
+    return std::chrono::steady_clock::now() + remaining;
+}
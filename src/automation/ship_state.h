@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+
+#include "../data_layer/schema.h"
+#include "../data_layer/server_clock.h"
+
+namespace automation
+{
+    namespace ship
+    {
+        class ShipState
+        {
+        public:
+            ShipState(schema::Ship &ship, std::chrono::seconds cargoRevalidateInterval, const dal::ServerClock &clock);
+
+            const schema::Cargo &getCargo() const;
+            bool applyCargo(const schema::Cargo &cargo, int expectedChange);
+            void syncCargo(const schema::Cargo &cargo);
+            void markCargoStale();
+            bool isCargoStale() const;
+
+            void applyNav(const schema::Nav &nav);
+            void setNavStatus(const std::string &status);
+            const std::string &getNavStatus();
+            // timestamps are preferred, the whole seconds only stand in when a response has none
+            void setArrival(const std::string &arrivalTime, std::chrono::seconds remaining);
+            std::chrono::steady_clock::time_point getArrival() const;
+            bool isInTransit() const;
+            void setCooldown(const std::string &expiration, std::chrono::seconds remaining);
+            void setCooldown(std::chrono::steady_clock::time_point expiry);
+            std::chrono::steady_clock::time_point getCooldownExpiry() const;
+            bool isOnCooldown() const;
+
+        private:
+            std::chrono::steady_clock::time_point toSteady(const std::string &timestamp, std::chrono::seconds remaining) const;
+
+            /* Responses to extract, sell and deliver already carry the cargo after the action,
+            so they are trusted as is. The cargo endpoint is only asked again when a response
+            disagrees with the change we expected, or when the last full sync is too old.
+            */
+            schema::Ship *p_ship;
+            const dal::ServerClock *p_clock;
+            std::chrono::seconds cargoRevalidateInterval;
+            std::chrono::steady_clock::time_point lastCargoSync;
+            bool cargoStale;
+
+            /* Cooldown expiry and arrival as reported by the server, moved onto the steady clock. While
+            either lies ahead the matching calls are known to fail, so the ship sleeps until then.
+            */
+            std::chrono::steady_clock::time_point arrival;
+            std::chrono::steady_clock::time_point cooldownExpiry;
+        };
+    }
+}
@@ -0,0 +1,122 @@
+#include "waypoint_map.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace automation;
+
+const char *automation::flightModeName(FlightMode mode)
+{
+    switch (mode)
+    {
+    case CRUISE:
+        return "CRUISE";
+    case BURN:
+        return "BURN";
+    case DRIFT:
+        return "DRIFT";
+    case STEALTH:
+        return "STEALTH";
+    }
+    return "CRUISE";
+}
+
+void WaypointMap::add(const schema::NavRouteWaypoint &waypoint)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    node(waypoint.symbol, waypoint.x, waypoint.y);
+}
+
+void WaypointMap::add(const schema::Waypoint &waypoint)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    node(waypoint.symbol, waypoint.x, waypoint.y);
+}
+
+void WaypointMap::setFuelStation(const std::string &waypointSymbol, bool fuelStation)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto entry = nodes.find(waypointSymbol);
+    if (entry != nodes.end())
+    {
+        entry->second.fuelStation = fuelStation;
+    }
+}
+
+bool WaypointMap::distance(const std::string &from, const std::string &to, double &result) const
+{
+    if (from == to)
+    {
+        result = 0;
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto origin = nodes.find(from);
+    auto destination = nodes.find(to);
+    if (origin == nodes.end() || destination == nodes.end())
+    {
+        return false;
+    }
+    result = std::hypot(origin->second.x - destination->second.x, origin->second.y - destination->second.y);
+    return true;
+}
+
+std::vector<WaypointMap::Node> WaypointMap::getNodes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Node> result;
+    result.reserve(nodes.size());
+    for (auto &entry : nodes)
+    {
+        result.push_back(entry.second);
+    }
+    return result;
+}
+
+double WaypointMap::travelSeconds(double distance, int speed, FlightMode mode)
+{
+    double multiplier = 25;
+    switch (mode)
+    {
+    case CRUISE:
+        multiplier = 25;
+        break;
+    case BURN:
+        multiplier = 12.5;
+        break;
+    case DRIFT:
+        multiplier = 250;
+        break;
+    case STEALTH:
+        multiplier = 30;
+        break;
+    }
+    return std::round(std::round(std::max(1.0, distance)) * (multiplier / speed) + 15);
+}
+
+int WaypointMap::fuelCost(double distance, FlightMode mode)
+{
+    switch (mode)
+    {
+    case DRIFT:
+        return 1;
+    case BURN:
+        return std::max(1, 2 * (int)std::round(distance));
+    default:
+        return std::max(1, (int)std::round(distance));
+    }
+}
+
+WaypointMap::Node &WaypointMap::node(const std::string &symbol, int x, int y)
+{
+    // the fuel station flag survives a waypoint being seen again on a route
+    auto entry = nodes.find(symbol);
+    if (entry == nodes.end())
+    {
+        entry = nodes.emplace(symbol, Node{symbol, x, y, false}).first;
+    }
+    entry->second.x = x;
+    entry->second.y = y;
+    return entry->second;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../data_layer/schema.h"
+
+namespace automation
+{
+    enum FlightMode
+    {
+        CRUISE,
+        BURN,
+        DRIFT,
+        STEALTH,
+    };
+
+    const int FLIGHT_MODES = 4;
+
+    const char *flightModeName(FlightMode mode);
+
+    /* The waypoints of the systems the fleet flies in, loaded once from the waypoint listing and
+    topped up with every waypoint seen on a nav route. Every pair of waypoints is connected, so
+    this is the graph the planners put a travel time and a fuel bill on. Thread safe.
+    */
+    class WaypointMap
+    {
+    public:
+        struct Node
+        {
+            std::string symbol;
+            int x;
+            int y;
+            bool fuelStation;
+        };
+
+        void add(const schema::NavRouteWaypoint &waypoint);
+        void add(const schema::Waypoint &waypoint);
+        void setFuelStation(const std::string &waypointSymbol, bool fuelStation);
+        // false while either end has not been seen yet
+        bool distance(const std::string &from, const std::string &to, double &result) const;
+        std::vector<Node> getNodes() const;
+
+        // as the game computes them, DRIFT always burns a single unit of fuel
+        static double travelSeconds(double distance, int speed, FlightMode mode = CRUISE);
+        static int fuelCost(double distance, FlightMode mode = CRUISE);
+
+    private:
+        Node &node(const std::string &symbol, int x, int y);
+
+        std::unordered_map<std::string, Node> nodes;
+        mutable std::mutex mutex;
+    };
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/* Count every heap allocation made by the process, the benchmark reads the counter around
+the section it measures. Replaces the global operator new, so it is included by exactly one
+translation unit of a benchmark.
+*/
+static std::atomic<long> allocationCount(0);
+
+void *operator new(std::size_t size)
+{
+    allocationCount++;
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,218 @@
+#include "spdlog/spdlog.h"
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../data_layer/data_access.h"
+#include "../data_layer/schema.h"
+#include "../automation/ship_auto.h"
+#include "../automation/scheduler.h"
+#include "../automation/fleet.h"
+#include "../mock_server/mock_server.h"
+#include "stats.h"
+
+/* Runs the whole fleet loop, ShipAutomator on the Scheduler through the DAL, against an
+in-process mock server and reports what a regression in any of them would move.
+The DAL reads ACCESS_TOKEN at startup, any value works against the mock.
+
+usage: ACCESS_TOKEN=mock fleet_bench [--fleets 1,10,100,1000] [--duration 30] [--time-scale 60]
+                                     [--rate 500] [--workers 8] [--connections 4] [--port 8090]
+*/
+
+struct BenchConfig
+{
+    std::vector<int> fleets = {1, 10, 100, 1000};
+    int duration = 30;
+    double timeScale = 60.0;
+    double requestsPerSecond = 500.0;
+    int workers = 8;
+    int connections = 4;
+    int port = 8090;
+};
+
+struct LatencyLog
+{
+    std::mutex mutex;
+    std::vector<long long> latencies;
+    long rateLimited = 0;
+
+    void record(const dal::RequestRecord &record)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        latencies.push_back(record.latency.count());
+        if (record.statusCode == error::ErrorCode::RATE_LIMITED)
+        {
+            rateLimited++;
+        }
+    }
+};
+
+void runFleet(const BenchConfig &bench, int shipCount, int port)
+{
+    mock::MockConfig mockConfig;
+    mockConfig.shipCount = shipCount;
+    mockConfig.timeScale = bench.timeScale;
+    mockConfig.requestsPerSecond = bench.requestsPerSecond;
+    mockConfig.burst = std::max(10, (int)bench.requestsPerSecond / 10);
+
+    const std::string uri = fmt::format("http://127.0.0.1:{}/v2/", port);
+    mock::MockServer server(uri, mockConfig);
+    server.open();
+
+    LatencyLog latencyLog;
+    dal::DataAccessConfig dalConfig;
+    dalConfig.requestsPerSecond = mockConfig.requestsPerSecond;
+    dalConfig.burst = mockConfig.burst;
+    dalConfig.connections = bench.connections;
+    dalConfig.requestObserver = [&latencyLog](const dal::RequestRecord &record)
+    {
+        latencyLog.record(record);
+    };
+    dal::DataAccessLayer DALInstance(uri, dalConfig);
+
+    std::vector<schema::Ship> ships = DALInstance.getShips();
+    if (ships.empty())
+    {
+        // nothing to load the waypoints of, nor to run
+        fmt::print("{:>6} no ships\n", shipCount);
+        server.close();
+        return;
+    }
+    automation::Fleet fleet({"X1-VS75-67965Z"});
+    fleet.load(DALInstance, ships.front().nav.systemSymbol);
+    std::vector<automation::ship::ShipAutomator> shipAutomators;
+    shipAutomators.reserve(ships.size());
+    for (auto &ship : ships)
+    {
+        shipAutomators.emplace_back(ship, DALInstance, fleet);
+    }
+
+    // busy time is spent inside step(), everything else a ship waits in the scheduler
+    std::vector<std::chrono::steady_clock::duration> busy(shipAutomators.size());
+    std::vector<long> steps(shipAutomators.size());
+    automation::Scheduler scheduler(bench.workers);
+    for (size_t i = 0; i < shipAutomators.size(); i++)
+    {
+        scheduler.add([&shipAutomators, &busy, &steps, i]()
+                      {
+                          auto start = std::chrono::steady_clock::now();
+                          std::chrono::milliseconds delay = shipAutomators[i].step();
+                          busy[i] += std::chrono::steady_clock::now() - start;
+                          steps[i]++;
+                          return delay; });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread runner(&automation::Scheduler::run, &scheduler);
+    std::this_thread::sleep_for(std::chrono::seconds(bench.duration));
+    scheduler.stop();
+    runner.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    server.close();
+
+    long totalSteps = 0;
+    double totalIdle = 0;
+    for (size_t i = 0; i < shipAutomators.size(); i++)
+    {
+        totalSteps += steps[i];
+        totalIdle += elapsed - std::chrono::duration<double>(busy[i]).count();
+    }
+
+    mock::MockStats stats = server.getStats();
+    std::lock_guard<std::mutex> lock(latencyLog.mutex);
+    size_t requests = latencyLog.latencies.size();
+    long long p50 = percentile(latencyLog.latencies, 0.50);
+    long long p99 = percentile(latencyLog.latencies, 0.99);
+    double gameHours = elapsed * bench.timeScale / 3600.0;
+
+    fmt::print("{:>6} {:>10.1f} {:>10.1f} {:>14.0f} {:>9.2f} {:>9.2f} {:>7} {:>9.1f}%\n",
+               shipCount,
+               totalSteps / elapsed,
+               requests / elapsed,
+               stats.credits / gameHours,
+               p50 / 1000.0,
+               p99 / 1000.0,
+               stats.rateLimited,
+               shipAutomators.empty() ? 0.0 : 100.0 * totalIdle / (elapsed * shipAutomators.size()));
+
+    std::vector<dal::ConnectionStats> connectionStats = DALInstance.getConnectionStats();
+    for (size_t i = 0; i < connectionStats.size(); i++)
+    {
+        fmt::print("{:>6} connection {}: {} requests, {} failed, {:.2f} ms mean\n",
+                   "", i, connectionStats[i].requests, connectionStats[i].failures, connectionStats[i].meanLatency.count() / 1000.0);
+    }
+}
+
+std::vector<int> parseFleets(const std::string &value)
+{
+    std::vector<int> fleets;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        fleets.push_back(std::stoi(item));
+    }
+    return fleets;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchConfig bench;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string flag = argv[i];
+        std::string value = argv[i + 1];
+        if (flag == "--fleets")
+        {
+            bench.fleets = parseFleets(value);
+        }
+        else if (flag == "--duration")
+        {
+            bench.duration = std::stoi(value);
+        }
+        else if (flag == "--time-scale")
+        {
+            bench.timeScale = std::stod(value);
+        }
+        else if (flag == "--rate")
+        {
+            bench.requestsPerSecond = std::stod(value);
+        }
+        else if (flag == "--workers")
+        {
+            bench.workers = std::stoi(value);
+        }
+        else if (flag == "--connections")
+        {
+            bench.connections = std::stoi(value);
+        }
+        else if (flag == "--port")
+        {
+            bench.port = std::stoi(value);
+        }
+        else
+        {
+            fmt::print("Unknown flag {}\n", flag);
+            return 1;
+        }
+    }
+    // the automators log every action, only problems are worth printing here
+    spdlog::set_level(spdlog::level::warn);
+
+    fmt::print("{}s per fleet at {}x game time, {} requests/s allowed, {} workers, {} connections\n",
+               bench.duration, bench.timeScale, bench.requestsPerSecond, bench.workers, bench.connections);
+    fmt::print("{:>6} {:>10} {:>10} {:>14} {:>9} {:>9} {:>7} {:>10}\n",
+               "ships", "steps/s", "req/s", "credits/game-h", "p50 ms", "p99 ms", "429s", "idle");
+    for (size_t i = 0; i < bench.fleets.size(); i++)
+    {
+        // a fresh port per fleet keeps lingering connections of the previous run out of the way
+        runFleet(bench, bench.fleets[i], bench.port + (int)i);
+    }
+    return 0;
+}
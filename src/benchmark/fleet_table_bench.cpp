@@ -0,0 +1,219 @@
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../automation/fleet_table.h"
+#include "timer_wheel.h"
+
+/* Replays the scheduler's timer thread on a simulated clock for fleets of every size and times
+only the selection of due ships: every due ship goes straight back with a random delay, as if its
+step had taken no time. Three layouts are compared,
+    table   the FleetTable scan, waking at the earliest deadline like Scheduler::timerLoop
+    objects the same scan over one heap object per ship, strings and all
+    wheel   the TimerWheel, waking every tick while anything is waiting
+Each wakeup is a thread waking up in the real scheduler, which costs more than a small scan.
+
+usage: fleet_table_bench [--fleets 100,1000,10000] [--seconds 120] [--max-delay 70000]
+*/
+
+typedef std::chrono::steady_clock Clock;
+
+struct BenchConfig
+{
+    std::vector<int> fleets = {100, 1000, 10000};
+    int seconds = 120;
+    // cooldowns and flights, in milliseconds
+    int maxDelay = 70000;
+};
+
+struct BenchResult
+{
+    long wakeups = 0;
+    long selected = 0;
+    double seconds = 0;
+};
+
+// what a ship used to be to the scheduler, for comparison
+struct ShipObject
+{
+    std::string shipSymbol;
+    std::string waypointSymbol;
+    std::string targetWaypoint;
+    int status = 0;
+    Clock::time_point wakeAt = Clock::time_point::max();
+};
+
+std::vector<int> parseList(const std::string &value)
+{
+    std::vector<int> values;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        values.push_back(std::stoi(item));
+    }
+    return values;
+}
+
+BenchResult runTable(const BenchConfig &bench, int shipCount)
+{
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> delay(1, bench.maxDelay);
+    const Clock::time_point origin = Clock::time_point();
+    const Clock::time_point end = origin + std::chrono::seconds(bench.seconds);
+
+    automation::FleetTable table(origin);
+    for (int i = 0; i < shipCount; i++)
+    {
+        table.setWake(table.addRow(), origin + std::chrono::milliseconds(delay(random)));
+    }
+
+    BenchResult result;
+    std::vector<std::size_t> due;
+    Clock::time_point now = origin;
+    auto start = Clock::now();
+    while (now < end)
+    {
+        table.collectDue(now, due);
+        result.wakeups++;
+        result.selected += due.size();
+        for (std::size_t row : due)
+        {
+            table.setWake(row, now + std::chrono::milliseconds(delay(random)));
+        }
+        due.clear();
+        now = std::max(now + std::chrono::milliseconds(1), table.nextDue());
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
+
+BenchResult runObjects(const BenchConfig &bench, int shipCount)
+{
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> delay(1, bench.maxDelay);
+    const Clock::time_point origin = Clock::time_point();
+    const Clock::time_point end = origin + std::chrono::seconds(bench.seconds);
+
+    std::vector<std::unique_ptr<ShipObject>> ships;
+    for (int i = 0; i < shipCount; i++)
+    {
+        ships.emplace_back(new ShipObject());
+        ships.back()->shipSymbol = fmt::format("BENCH-{}", i + 1);
+        ships.back()->waypointSymbol = "X1-VS75-67965Z";
+        ships.back()->wakeAt = origin + std::chrono::milliseconds(delay(random));
+    }
+
+    BenchResult result;
+    std::vector<std::size_t> due;
+    Clock::time_point now = origin;
+    auto start = Clock::now();
+    while (now < end)
+    {
+        Clock::time_point next = Clock::time_point::max();
+        for (std::size_t i = 0; i < ships.size(); i++)
+        {
+            if (ships[i]->wakeAt <= now)
+            {
+                due.push_back(i);
+                ships[i]->wakeAt = now + std::chrono::milliseconds(delay(random));
+            }
+            next = std::min(next, ships[i]->wakeAt);
+        }
+        result.wakeups++;
+        result.selected += due.size();
+        due.clear();
+        now = std::max(now + std::chrono::milliseconds(1), next);
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
+
+BenchResult runWheel(const BenchConfig &bench, int shipCount)
+{
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> delay(1, bench.maxDelay);
+    const Clock::time_point origin = Clock::time_point();
+    const Clock::time_point end = origin + std::chrono::seconds(bench.seconds);
+
+    automation::TimerWheel wheel(std::chrono::milliseconds(1), origin);
+    for (int i = 0; i < shipCount; i++)
+    {
+        wheel.schedule(i, origin + std::chrono::milliseconds(delay(random)));
+    }
+
+    BenchResult result;
+    std::vector<std::size_t> due;
+    Clock::time_point now = origin;
+    auto start = Clock::now();
+    while (now < end)
+    {
+        wheel.advance(now, due);
+        result.wakeups++;
+        result.selected += due.size();
+        for (std::size_t id : due)
+        {
+            wheel.schedule(id, now + std::chrono::milliseconds(delay(random)));
+        }
+        due.clear();
+        now = wheel.nextTick();
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
+
+void printResult(const char *layout, int shipCount, const BenchResult &result)
+{
+    fmt::print("{:>8} {:>8} {:>10} {:>10} {:>12.0f} {:>12.1f} {:>10.3f}\n",
+               layout,
+               shipCount,
+               result.wakeups,
+               result.selected,
+               result.wakeups == 0 ? 0.0 : result.seconds * 1e9 / result.wakeups,
+               result.selected == 0 ? 0.0 : result.seconds * 1e9 / result.selected,
+               result.seconds * 1e3);
+}
+
+int main(int argc, char *argv[])
+{
+    BenchConfig bench;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string flag = argv[i];
+        std::string value = argv[i + 1];
+        if (flag == "--fleets")
+        {
+            bench.fleets = parseList(value);
+        }
+        else if (flag == "--seconds")
+        {
+            bench.seconds = std::stoi(value);
+        }
+        else if (flag == "--max-delay")
+        {
+            bench.maxDelay = std::max(1, std::stoi(value));
+        }
+        else
+        {
+            fmt::print("Unknown flag {}\n", flag);
+            return 1;
+        }
+    }
+
+    fmt::print("{}s simulated, delays up to {}ms\n", bench.seconds, bench.maxDelay);
+    fmt::print("{:>8} {:>8} {:>10} {:>10} {:>12} {:>12} {:>10}\n", "layout", "ships", "wakeups", "selected", "ns/wakeup", "ns/ship", "total ms");
+    for (int shipCount : bench.fleets)
+    {
+        printResult("table", shipCount, runTable(bench, shipCount));
+        printResult("objects", shipCount, runObjects(bench, shipCount));
+        printResult("wheel", shipCount, runWheel(bench, shipCount));
+    }
+    return 0;
+}
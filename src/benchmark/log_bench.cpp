@@ -0,0 +1,45 @@
+#include "spdlog/spdlog.h"
+#include "spdlog/sinks/null_sink.h"
+#include <fmt/core.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+#include "../data_layer/logging.h"
+#include "payloads.h"
+
+using namespace web;
+
+/* Replays the messages DataAccessLayer writes for a single extract call, against a sink that
+drops everything, so the numbers are the cost of deciding and formatting only.
+*/
+double measure(spdlog::level::level_enum level, const json::value &response, int iterations)
+{
+    spdlog::set_level(level);
+    logging::Logger logger("DAL");
+    const std::string shipSymbol = "GET_RICH_QUICK-1";
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        logger.debug("Mining with {}...", shipSymbol);
+        logger.debug("Checking for error in response = {}...", logging::lazy(response));
+        logger.debug("No error found in response.");
+        logger.debug("Mined with {}.", shipSymbol);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 100000;
+    spdlog::set_default_logger(spdlog::null_logger_mt("null"));
+    const json::value response = json::value::parse(payloads::EXTRACT);
+
+    fmt::print("Logging cost per DAL call, {} iterations:\n", iterations);
+    fmt::print("debug: {:>9.1f} ns\n", measure(spdlog::level::debug, response, iterations));
+    fmt::print("info:  {:>9.1f} ns\n", measure(spdlog::level::info, response, iterations));
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <fmt/core.h>
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../data_layer/schema.h"
+#include "alloc_counter.h"
+#include "payloads.h"
+
+using namespace web;
+
+void run(const std::string &name, const char *payload, int iterations, const std::function<void(const json::value &)> &parse)
+{
+    const json::value json = json::value::parse(payload);
+
+    long treeAllocations = allocationCount;
+    auto treeStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        json::value::parse(payload);
+    }
+    auto treeEnd = std::chrono::steady_clock::now();
+    treeAllocations = allocationCount - treeAllocations;
+
+    long schemaAllocations = allocationCount;
+    auto schemaStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        parse(json);
+    }
+    auto schemaEnd = std::chrono::steady_clock::now();
+    schemaAllocations = allocationCount - schemaAllocations;
+
+    fmt::print("{:<10} tree: {:>7.1f} allocs {:>9.0f} ns | schema: {:>7.1f} allocs {:>9.0f} ns\n",
+               name,
+               (double)treeAllocations / iterations,
+               std::chrono::duration<double, std::nano>(treeEnd - treeStart).count() / iterations,
+               (double)schemaAllocations / iterations,
+               std::chrono::duration<double, std::nano>(schemaEnd - schemaStart).count() / iterations);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 20000;
+    fmt::print("Parsing captured payloads, {} iterations each, per response:\n", iterations);
+
+    run("ship", payloads::SHIP, iterations, [](const json::value &json)
+        { schema::Ship ship(json); });
+    run("extract", payloads::EXTRACT, iterations, [](const json::value &json)
+        { schema::ExtractResponse response(json); });
+    run("sell", payloads::SELL, iterations, [](const json::value &json)
+        { schema::SellResponse response(json); });
+    run("navigate", payloads::NAVIGATE, iterations, [](const json::value &json)
+        { schema::NavResponse response(json); });
+    return 0;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+// Responses captured from the live API, trimmed to one ship and with the token scrubbed.
+namespace payloads
+{
+    const char *const SHIP = R"({
+    "symbol": "GET_RICH_QUICK-1",
+    "registration": {"name": "GET_RICH_QUICK-1", "factionSymbol": "COSMIC", "role": "COMMAND"},
+    "nav": {
+        "systemSymbol": "X1-VS75",
+        "waypointSymbol": "X1-VS75-67965Z",
+        "route": {
+            "departure": {"symbol": "X1-VS75-70500X", "type": "PLANET", "systemSymbol": "X1-VS75", "x": 14, "y": -22},
+            "destination": {"symbol": "X1-VS75-67965Z", "type": "ASTEROID_FIELD", "systemSymbol": "X1-VS75", "x": -3, "y": 8},
+            "arrival": "2023-05-27T08:12:54.412Z",
+            "departureTime": "2023-05-27T08:11:27.412Z"
+        },
+        "status": "IN_ORBIT",
+        "flightMode": "CRUISE"
+    },
+    "crew": {"current": 0, "capacity": 80, "required": 0, "rotation": "STRICT", "morale": 100, "wages": 0},
+    "frame": {"symbol": "FRAME_FRIGATE", "name": "Frame Frigate", "description": "A medium-sized, multi-purpose spacecraft.", "condition": 100, "moduleSlots": 8, "mountingPoints": 5, "fuelCapacity": 1200, "requirements": {"power": 8, "crew": 25}},
+    "reactor": {"symbol": "REACTOR_FISSION_I", "name": "Fission Reactor I", "description": "A basic fission power reactor.", "condition": 100, "powerOutput": 31, "requirements": {"crew": 8}},
+    "engine": {"symbol": "ENGINE_ION_DRIVE_II", "name": "Ion Drive II", "description": "An advanced propulsion system.", "condition": 100, "speed": 30, "requirements": {"power": 6, "crew": 8}},
+    "modules": [
+        {"symbol": "MODULE_CARGO_HOLD_I", "name": "Cargo Hold", "description": "A module that increases a ship's cargo capacity.", "capacity": 30, "requirements": {"crew": 0, "power": 1, "slots": 1}},
+        {"symbol": "MODULE_CARGO_HOLD_I", "name": "Cargo Hold", "description": "A module that increases a ship's cargo capacity.", "capacity": 30, "requirements": {"crew": 0, "power": 1, "slots": 1}},
+        {"symbol": "MODULE_MINERAL_PROCESSOR_I", "name": "Mineral Processor", "description": "Crushes and processes extracted minerals.", "requirements": {"crew": 0, "power": 1, "slots": 2}}
+    ],
+    "mounts": [
+        {"symbol": "MOUNT_SENSOR_ARRAY_I", "name": "Sensor Array I", "description": "A basic sensor array.", "strength": 1, "requirements": {"crew": 0, "power": 1}},
+        {"symbol": "MOUNT_MINING_LASER_I", "name": "Mining Laser I", "description": "A basic mining laser.", "strength": 10, "requirements": {"crew": 0, "power": 1}}
+    ],
+    "cargo": {
+        "capacity": 60,
+        "units": 34,
+        "inventory": [
+            {"symbol": "IRON_ORE", "name": "Iron Ore", "description": "A common ore.", "units": 12},
+            {"symbol": "PLATINUM_ORE", "name": "Platinum Ore", "description": "A rare ore.", "units": 9},
+            {"symbol": "QUARTZ_SAND", "name": "Quartz Sand", "description": "Fine sand.", "units": 7},
+            {"symbol": "SILICON_CRYSTALS", "name": "Silicon Crystals", "description": "Crystals.", "units": 6}
+        ]
+    },
+    "fuel": {"current": 1080, "capacity": 1200, "consumed": {"amount": 38, "timestamp": "2023-05-27T08:11:27.412Z"}}
+})";
+
+    const char *const EXTRACT = R"({
+    "cooldown": {"shipSymbol": "GET_RICH_QUICK-1", "totalSeconds": 70, "remainingSeconds": 69, "expiration": "2023-05-27T08:14:05.018Z"},
+    "extraction": {"shipSymbol": "GET_RICH_QUICK-1", "yield": {"symbol": "PLATINUM_ORE", "units": 7}},
+    "cargo": {
+        "capacity": 60,
+        "units": 41,
+        "inventory": [
+            {"symbol": "IRON_ORE", "name": "Iron Ore", "description": "A common ore.", "units": 12},
+            {"symbol": "PLATINUM_ORE", "name": "Platinum Ore", "description": "A rare ore.", "units": 16},
+            {"symbol": "QUARTZ_SAND", "name": "Quartz Sand", "description": "Fine sand.", "units": 7},
+            {"symbol": "SILICON_CRYSTALS", "name": "Silicon Crystals", "description": "Crystals.", "units": 6}
+        ]
+    }
+})";
+
+    const char *const SELL = R"({
+    "agent": {"accountId": "clhw9c4hy0001s60dsuwbbbt8", "symbol": "GET_RICH_QUICK", "headquarters": "X1-VS75-70500X", "credits": 1385221},
+    "cargo": {
+        "capacity": 60,
+        "units": 29,
+        "inventory": [
+            {"symbol": "PLATINUM_ORE", "name": "Platinum Ore", "description": "A rare ore.", "units": 16},
+            {"symbol": "QUARTZ_SAND", "name": "Quartz Sand", "description": "Fine sand.", "units": 7},
+            {"symbol": "SILICON_CRYSTALS", "name": "Silicon Crystals", "description": "Crystals.", "units": 6}
+        ]
+    },
+    "transaction": {"waypointSymbol": "X1-VS75-67965Z", "shipSymbol": "GET_RICH_QUICK-1", "tradeSymbol": "IRON_ORE", "type": "SELL", "units": 12, "pricePerUnit": 38, "totalPrice": 456, "timestamp": "2023-05-27T08:16:02.102Z"}
+})";
+
+    const char *const NAVIGATE = R"({
+    "fuel": {"current": 1042, "capacity": 1200, "consumed": {"amount": 38, "timestamp": "2023-05-27T08:17:27.412Z"}},
+    "nav": {
+        "systemSymbol": "X1-VS75",
+        "waypointSymbol": "X1-VS75-70500X",
+        "route": {
+            "departure": {"symbol": "X1-VS75-67965Z", "type": "ASTEROID_FIELD", "systemSymbol": "X1-VS75", "x": -3, "y": 8},
+            "destination": {"symbol": "X1-VS75-70500X", "type": "PLANET", "systemSymbol": "X1-VS75", "x": 14, "y": -22},
+            "arrival": "2023-05-27T08:18:54.412Z",
+            "departureTime": "2023-05-27T08:17:27.412Z"
+        },
+        "status": "IN_TRANSIT",
+        "flightMode": "CRUISE"
+    }
+})";
+}
@@ -0,0 +1,151 @@
+#include "spdlog/spdlog.h"
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../data_layer/data_access.h"
+#include "../data_layer/schema.h"
+#include "../data_layer/traffic_log.h"
+#include "../automation/ship_auto.h"
+#include "../automation/scheduler.h"
+#include "../automation/fleet.h"
+#include "stats.h"
+
+/* Runs ShipAutomator on the Scheduler over a trace recorded with TRAFFIC_RECORD, no network involved.
+Every ship gets the answers it got in production, so the time spent inside step() can be compared
+between builds. Stops once the trace has nothing left or after --duration seconds.
+The DAL reads ACCESS_TOKEN at startup, any value works.
+
+usage: ACCESS_TOKEN=replay replay_bench --trace traffic.jsonl [--time-scale 60] [--duration 600] [--workers 8]
+*/
+
+struct BenchConfig
+{
+    std::string trace;
+    double timeScale = 60.0;
+    int duration = 600;
+    int workers = 8;
+};
+
+int main(int argc, char *argv[])
+{
+    BenchConfig bench;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string flag = argv[i];
+        std::string value = argv[i + 1];
+        if (flag == "--trace")
+        {
+            bench.trace = value;
+        }
+        else if (flag == "--time-scale")
+        {
+            bench.timeScale = std::stod(value);
+        }
+        else if (flag == "--duration")
+        {
+            bench.duration = std::stoi(value);
+        }
+        else if (flag == "--workers")
+        {
+            bench.workers = std::stoi(value);
+        }
+        else
+        {
+            fmt::print("Unknown flag {}\n", flag);
+            return 1;
+        }
+    }
+    if (bench.trace.empty())
+    {
+        fmt::print("--trace is required\n");
+        return 1;
+    }
+    // the automators log every action, only problems are worth printing here
+    spdlog::set_level(spdlog::level::warn);
+
+    auto replayer = std::make_shared<dal::TrafficReplayer>(bench.trace, bench.timeScale);
+    size_t recorded = replayer->getRemaining();
+    std::atomic<long> replayed(0);
+    dal::DataAccessConfig dalConfig;
+    // the trace was throttled by the live rate limit, which runs faster along with the trace
+    dalConfig.requestsPerSecond *= bench.timeScale;
+    dalConfig.burst = std::max(dalConfig.burst, (int)dalConfig.requestsPerSecond);
+    dalConfig.trafficReplayer = replayer;
+    dalConfig.requestObserver = [&replayed](const dal::RequestRecord &)
+    {
+        replayed++;
+    };
+    dal::DataAccessLayer DALInstance("http://127.0.0.1:1/v2/", dalConfig);
+
+    std::vector<schema::Ship> ships = DALInstance.getShips();
+    automation::Fleet fleet({"X1-VS75-67965Z"});
+    std::set<std::string> systems;
+    for (auto &ship : ships)
+    {
+        systems.insert(ship.nav.systemSymbol);
+    }
+    for (auto &system : systems)
+    {
+        fleet.load(DALInstance, system);
+    }
+    std::vector<automation::ship::ShipAutomator> shipAutomators;
+    shipAutomators.reserve(ships.size());
+    for (auto &ship : ships)
+    {
+        shipAutomators.emplace_back(ship, DALInstance, fleet);
+    }
+
+    // every step's busy time, the figure a regression in the state machine moves
+    std::mutex stepMutex;
+    std::vector<long long> stepMicros;
+    automation::Scheduler scheduler(bench.workers);
+    for (size_t i = 0; i < shipAutomators.size(); i++)
+    {
+        scheduler.add([&shipAutomators, &stepMutex, &stepMicros, i]()
+                      {
+                          auto start = std::chrono::steady_clock::now();
+                          std::chrono::milliseconds delay = shipAutomators[i].step();
+                          long long micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+                          std::lock_guard<std::mutex> lock(stepMutex);
+                          stepMicros.push_back(micros);
+                          return delay; });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::seconds(bench.duration);
+    std::thread runner(&automation::Scheduler::run, &scheduler);
+    while (replayer->getRemaining() > 0 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    scheduler.stop();
+    runner.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(stepMutex);
+    size_t steps = stepMicros.size();
+    long long total = 0;
+    for (long long micros : stepMicros)
+    {
+        total += micros;
+    }
+    fmt::print("{} ships, {} of {} recorded requests replayed in {:.1f}s at {}x\n",
+               ships.size(), replayed.load(), recorded, elapsed, bench.timeScale);
+    fmt::print("{:>10} {:>10} {:>12} {:>12} {:>12}\n", "steps", "steps/s", "mean us", "p50 us", "p99 us");
+    fmt::print("{:>10} {:>10.1f} {:>12.1f} {:>12} {:>12}\n",
+               steps,
+               steps / elapsed,
+               steps == 0 ? 0.0 : (double)total / steps,
+               percentile(stepMicros, 0.50),
+               percentile(stepMicros, 0.99));
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <fmt/core.h>
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+#include "../data_layer/request_templates.h"
+#include "alloc_counter.h"
+
+using namespace web;
+using namespace web::http;
+
+/* Cost of building a request before it is handed to the client, the way the DAL used to
+(string concatenation, URI parsing, JSON payload tree) against the cached templates.
+*/
+
+void measure(const std::string &name, int iterations, const std::function<void()> &build)
+{
+    // the first call fills the template cache
+    build();
+
+    long allocations = allocationCount;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        build();
+    }
+    auto end = std::chrono::steady_clock::now();
+    allocations = allocationCount - allocations;
+
+    fmt::print("{:<20} {:>9.1f} ns {:>7.1f} allocs\n",
+               name,
+               std::chrono::duration<double, std::nano>(end - start).count() / iterations,
+               (double)allocations / iterations);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const std::string token = "eyJhbGciOiJSUzI1NiIsInR5cCI6IkpXVCJ9.benchmark-token";
+    const std::string shipSymbol = "GET_RICH_QUICK-1";
+    const std::string tradeSymbol = "PLATINUM_ORE";
+    const std::string waypointSymbol = "X1-VS75-70500X";
+    const std::string contractId = "clhw9qowb0139s60dm28j6y4p";
+    dal::RequestTemplates templates(token);
+
+    fmt::print("Request construction, {} iterations:\n", iterations);
+
+    measure("extract rebuilt", iterations, [&]()
+            {
+                http_request request(methods::POST);
+                request.headers().add(U("Authorization"), U("Bearer ") + U(token));
+                request.set_request_uri(U("/my/ships/" + shipSymbol + "/extract"));
+                request.set_body(""); });
+    measure("extract template", iterations, [&]()
+            {
+                http_request request = templates.make(methods::POST, templates.ship(shipSymbol).extract);
+                request.set_body(""); });
+
+    measure("sell rebuilt", iterations, [&]()
+            {
+                json::value payload;
+                payload["symbol"] = json::value::string(tradeSymbol);
+                payload["units"] = json::value::number(10);
+                http_request request(methods::POST);
+                request.headers().add(U("Authorization"), U("Bearer ") + U(token));
+                request.set_request_uri(U("/my/ships/" + shipSymbol + "/sell"));
+                request.set_body(payload); });
+    measure("sell template", iterations, [&]()
+            {
+                http_request request = templates.make(methods::POST, templates.ship(shipSymbol).sell);
+                request.set_body(dal::RequestTemplates::sellPayload(tradeSymbol, 10), "application/json"); });
+
+    measure("navigate rebuilt", iterations, [&]()
+            {
+                json::value payload;
+                payload["waypointSymbol"] = json::value::string(waypointSymbol);
+                http_request request(methods::POST);
+                request.headers().add(U("Authorization"), U("Bearer ") + U(token));
+                request.set_request_uri(U("/my/ships/" + shipSymbol + "/navigate"));
+                request.set_body(payload); });
+    measure("navigate template", iterations, [&]()
+            {
+                http_request request = templates.make(methods::POST, templates.ship(shipSymbol).navigate);
+                request.set_body(dal::RequestTemplates::navigatePayload(waypointSymbol), "application/json"); });
+
+    measure("deliver rebuilt", iterations, [&]()
+            {
+                json::value payload;
+                payload["shipSymbol"] = json::value::string(shipSymbol);
+                payload["tradeSymbol"] = json::value::string(tradeSymbol);
+                payload["units"] = json::value::number(10);
+                http_request request(methods::POST);
+                request.headers().add(U("Authorization"), U("Bearer ") + U(token));
+                request.set_request_uri(U("/my/contracts/" + contractId + "/deliver"));
+                request.set_body(payload); });
+    measure("deliver template", iterations, [&]()
+            {
+                http_request request = templates.make(methods::POST, templates.contract(contractId).deliver);
+                request.set_body(dal::RequestTemplates::deliverPayload(shipSymbol, tradeSymbol, 10), "application/json"); });
+    return 0;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// the value below which the fraction of values lies, reorders values
+inline long long percentile(std::vector<long long> &values, double fraction)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+    std::size_t index = std::min(values.size() - 1, (std::size_t)(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
@@ -0,0 +1,90 @@
+#include "timer_wheel.h"
+
+using namespace automation;
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tickDuration, Clock::time_point origin)
+    : tickDuration(tickDuration), origin(origin), currentTick(0), timerCount(0)
+{
+}
+
+void TimerWheel::schedule(std::size_t id, Clock::time_point due)
+{
+    // round up so a timer never fires before it is due, and never into the slot already expired
+    std::uint64_t expiry = 0;
+    if (due > origin)
+    {
+        expiry = (std::uint64_t)((due - origin + tickDuration - Clock::duration(1)) / tickDuration);
+    }
+    if (expiry <= currentTick)
+    {
+        expiry = currentTick + 1;
+    }
+    insert(Timer{id, expiry});
+    timerCount++;
+}
+
+void TimerWheel::advance(Clock::time_point now, std::vector<std::size_t> &expired)
+{
+    if (now < origin)
+    {
+        return;
+    }
+    std::uint64_t targetTick = (std::uint64_t)((now - origin) / tickDuration);
+    while (currentTick < targetTick)
+    {
+        currentTick++;
+        if ((currentTick & ((std::uint64_t(1) << (SLOT_BITS * LEVELS)) - 1)) == 0)
+        {
+            cascade(overflow);
+        }
+        for (int level = LEVELS - 1; level > 0; level--)
+        {
+            if ((currentTick & ((std::uint64_t(1) << (SLOT_BITS * level)) - 1)) == 0)
+            {
+                cascade(slots[level][(currentTick >> (SLOT_BITS * level)) & (SLOTS - 1)]);
+            }
+        }
+
+        std::vector<Timer> &slot = slots[0][currentTick & (SLOTS - 1)];
+        for (const Timer &timer : slot)
+        {
+            expired.push_back(timer.id);
+        }
+        timerCount -= slot.size();
+        slot.clear();
+    }
+}
+
+TimerWheel::Clock::time_point TimerWheel::nextTick() const
+{
+    return origin + tickDuration * (currentTick + 1);
+}
+
+std::size_t TimerWheel::size() const
+{
+    return timerCount;
+}
+
+void TimerWheel::insert(Timer timer)
+{
+    std::uint64_t delta = timer.expiry > currentTick ? timer.expiry - currentTick : 0;
+    for (int level = 0; level < LEVELS; level++)
+    {
+        if (delta < (std::uint64_t(1) << (SLOT_BITS * (level + 1))))
+        {
+            slots[level][(timer.expiry >> (SLOT_BITS * level)) & (SLOTS - 1)].push_back(timer);
+            return;
+        }
+    }
+    overflow.push_back(timer);
+}
+
+void TimerWheel::cascade(std::vector<Timer> &slot)
+{
+    std::vector<Timer> timers;
+    timers.swap(slot);
+    for (const Timer &timer : timers)
+    {
+        insert(timer);
+    }
+}
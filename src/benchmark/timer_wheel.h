@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace automation
+{
+    class TimerWheel
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        TimerWheel(std::chrono::milliseconds tickDuration, Clock::time_point origin);
+        void schedule(std::size_t id, Clock::time_point due);
+        void advance(Clock::time_point now, std::vector<std::size_t> &expired);
+        Clock::time_point nextTick() const;
+        std::size_t size() const;
+
+    private:
+        /* Hierarchical wheel: level 0 holds timers due within 64 ticks, each level above covers
+        64 times the range of the one below. Timers cascade down a level when the wheel below
+        wraps around, so scheduling and expiring a timer are both O(1).
+        */
+        static const int LEVELS = 4;
+        static const int SLOT_BITS = 6;
+        static const int SLOTS = 1 << SLOT_BITS;
+
+        struct Timer
+        {
+            std::size_t id;
+            std::uint64_t expiry;
+        };
+
+        void insert(Timer timer);
+        void cascade(std::vector<Timer> &slot);
+
+        std::chrono::milliseconds tickDuration;
+        Clock::time_point origin;
+        std::uint64_t currentTick;
+        std::size_t timerCount;
+        std::vector<Timer> slots[LEVELS][SLOTS];
+        std::vector<Timer> overflow;
+    };
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "result.h"
+#include "schema.h"
+
+namespace dal
+{
+    struct SellOrder
+    {
+        std::string tradeSymbol;
+        int units;
+    };
+
+    struct DeliverOrder
+    {
+        std::string contractId;
+        std::string tradeSymbol;
+        int units;
+    };
+
+    /* Outcome of a batch of requests for one ship that were all in flight at once. Every request
+    is waited on, so a failure never leaves a task behind, and the ship's cargo is reconciled
+    once from the response the server processed last instead of after every request.
+    */
+    template <typename T>
+    struct BatchResult
+    {
+        // one per order and in the same order, a request that threw holds an empty result
+        std::vector<Result<T>> results;
+        // the first unexpected failure, for the caller to rethrow once it has looked at the rest
+        std::exception_ptr failure;
+        // units moved by the requests that went through
+        int units = 0;
+        // only set if at least one request went through
+        bool hasCargo = false;
+        schema::Cargo cargo;
+
+        // the first expected game error of the batch, nullptr if there was none
+        const error::GameError *firstError() const
+        {
+            for (auto &result : results)
+            {
+                if (!result.ok() && result.error().code != 0)
+                {
+                    return &result.error();
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    typedef BatchResult<schema::SellResponse> SellBatch;
+    typedef BatchResult<schema::DeliverResponse> DeliverBatch;
+}
@@ -0,0 +1,165 @@
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "connection_pool.h"
+
+using namespace dal;
+using namespace web;
+using namespace web::http;
+using namespace web::http::client;
+
+http_client_config clientConfig(std::chrono::milliseconds timeout)
+{
+    http_client_config config;
+    config.set_timeout(timeout);
+    return config;
+}
+
+ConnectionPool::Connection::Connection(const std::string &baseURI, std::chrono::milliseconds timeout)
+    : client(U(baseURI), clientConfig(timeout)), inFlight(0), requests(0), failures(0), totalLatency(0)
+{
+}
+
+ConnectionPool::ConnectionPool(const std::string &baseURI, int size, std::chrono::milliseconds maxTimeout)
+    : running(true)
+{
+    const int count = std::max(1, size);
+    connections.reserve(count);
+    for (int i = 0; i < count; i++)
+    {
+        connections.emplace_back(new Connection(baseURI, maxTimeout));
+        idle.push_back(connections.back().get());
+    }
+    watcher = std::thread(&ConnectionPool::watchDeadlines, this);
+}
+
+ConnectionPool::~ConnectionPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(deadlineMutex);
+        running = false;
+    }
+    deadlineChanged.notify_one();
+    watcher.join();
+}
+
+pplx::task<http_response> ConnectionPool::request(http_request request, std::chrono::milliseconds timeout)
+{
+    Pending pending{request, std::chrono::steady_clock::now(), timeout, pplx::cancellation_token_source(), pplx::task_completion_event<http_response>()};
+    {
+        std::lock_guard<std::mutex> lock(deadlineMutex);
+        deadlines.push(Deadline{pending.start + timeout, pending.source});
+    }
+    deadlineChanged.notify_one();
+    // the deadline also covers the wait for a connection, a request still waiting is failed right away
+    auto result = pending.result;
+    pending.source.get_token().register_callback([result, timeout]()
+                                                 { result.set_exception(RequestTimeout("No response within " + std::to_string(timeout.count()) + " ms")); });
+
+    Connection *p_connection = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(connectionMutex);
+        if (idle.empty())
+        {
+            waiting.push(pending);
+        }
+        else
+        {
+            p_connection = idle.back();
+            idle.pop_back();
+        }
+    }
+    if (p_connection != nullptr)
+    {
+        send(*p_connection, pending);
+    }
+    return pplx::create_task(result);
+}
+
+void ConnectionPool::send(Connection &connection, Pending pending)
+{
+    connection.inFlight++;
+    connection.client.request(pending.request, pending.source.get_token())
+        .then([this, &connection, pending](pplx::task<http_response> task)
+              {
+                  connection.inFlight--;
+                  try
+                  {
+                      http_response response = task.get();
+                      auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - pending.start);
+                      connection.requests++;
+                      connection.totalLatency += latency.count();
+                      pending.result.set(response);
+                  }
+                  catch (const pplx::task_canceled &)
+                  {
+                      // the timeout itself has already been set by the token's callback
+                      connection.failures++;
+                  }
+                  catch (...)
+                  {
+                      connection.failures++;
+                      pending.result.set_exception(std::current_exception());
+                  }
+                  release(connection); });
+}
+
+void ConnectionPool::release(Connection &connection)
+{
+    Pending next;
+    {
+        std::lock_guard<std::mutex> lock(connectionMutex);
+        // requests that timed out while waiting have already failed, they are not sent at all
+        while (!waiting.empty() && waiting.front().source.get_token().is_canceled())
+        {
+            waiting.pop();
+        }
+        if (waiting.empty())
+        {
+            idle.push_back(&connection);
+            return;
+        }
+        next = waiting.front();
+        waiting.pop();
+    }
+    send(connection, next);
+}
+
+std::vector<ConnectionStats> ConnectionPool::getStats() const
+{
+    std::vector<ConnectionStats> stats;
+    stats.reserve(connections.size());
+    for (const auto &connection : connections)
+    {
+        std::uint64_t requests = connection->requests.load();
+        std::uint64_t meanLatency = requests == 0 ? 0 : connection->totalLatency.load() / requests;
+        stats.push_back(ConnectionStats{requests, connection->failures.load(), connection->inFlight.load(), std::chrono::microseconds(meanLatency)});
+    }
+    return stats;
+}
+
+void ConnectionPool::watchDeadlines()
+{
+    std::unique_lock<std::mutex> lock(deadlineMutex);
+    while (running)
+    {
+        if (deadlines.empty())
+        {
+            deadlineChanged.wait(lock);
+            continue;
+        }
+        if (deadlines.top().time > std::chrono::steady_clock::now())
+        {
+            deadlineChanged.wait_until(lock, deadlines.top().time);
+            continue;
+        }
+        // cancelling may run the continuation right here, which must be free to start a request
+        pplx::cancellation_token_source source = deadlines.top().source;
+        deadlines.pop();
+        lock.unlock();
+        source.cancel();
+        lock.lock();
+    }
+}
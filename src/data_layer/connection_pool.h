@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cpprest/http_client.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dal
+{
+    struct ConnectionStats
+    {
+        std::uint64_t requests;
+        std::uint64_t failures;
+        int inFlight;
+        // mean round trip of completed requests
+        std::chrono::microseconds meanLatency;
+    };
+
+    class RequestTimeout : public std::runtime_error
+    {
+    public:
+        RequestTimeout(const std::string &message) : std::runtime_error(message) {}
+    };
+
+    class ConnectionPool
+    {
+    public:
+        // maxTimeout bounds every request, a shorter one can be given per request
+        ConnectionPool(const std::string &baseURI, int size, std::chrono::milliseconds maxTimeout = std::chrono::seconds(30));
+        ~ConnectionPool();
+        // fails with RequestTimeout once timeout has passed without a response
+        pplx::task<web::http::http_response> request(web::http::http_request request, std::chrono::milliseconds timeout);
+        std::vector<ConnectionStats> getStats() const;
+
+    private:
+        /* A cpprest http_client opens another connection for every concurrent request, so each
+        client is given one request at a time. That makes every client a single keep-alive
+        connection which is reused for all of its requests, and the pool size the number of
+        connections to the host. Requests beyond that wait in the pool for the first free one.
+        */
+        struct Connection
+        {
+            Connection(const std::string &baseURI, std::chrono::milliseconds timeout);
+            web::http::client::http_client client;
+            std::atomic<int> inFlight;
+            std::atomic<std::uint64_t> requests;
+            std::atomic<std::uint64_t> failures;
+            std::atomic<std::uint64_t> totalLatency;
+        };
+
+        struct Pending
+        {
+            web::http::http_request request;
+            std::chrono::steady_clock::time_point start;
+            std::chrono::milliseconds timeout;
+            pplx::cancellation_token_source source;
+            pplx::task_completion_event<web::http::http_response> result;
+        };
+
+        /* cpprest only knows one timeout per client, so shorter ones cancel the request instead.
+        Deadlines are kept in a heap and left there when the response comes first, cancelling
+        a finished request does nothing.
+        */
+        struct Deadline
+        {
+            std::chrono::steady_clock::time_point time;
+            pplx::cancellation_token_source source;
+
+            bool operator>(const Deadline &other) const
+            {
+                return time > other.time;
+            }
+        };
+
+        void send(Connection &connection, Pending pending);
+        // hands the connection to the next waiting request or marks it idle
+        void release(Connection &connection);
+        void watchDeadlines();
+
+        std::vector<std::unique_ptr<Connection>> connections;
+        std::vector<Connection *> idle;
+        std::queue<Pending> waiting;
+        std::mutex connectionMutex;
+        std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> deadlines;
+        std::mutex deadlineMutex;
+        std::condition_variable deadlineChanged;
+        bool running;
+        std::thread watcher;
+    };
+};
@@ -1,12 +1,15 @@
 #include "spdlog/spdlog.h"
 #include <fmt/core.h>
 
+#include <algorithm>
 #include <ctime>
-#include <thread>
+#include <functional>
 
 #include "data_access.h"
 #include "schema.h"
 #include "error.h"
+#include "logging.h"
+#include "../metrics/metrics.h"
 
 using namespace dal;
 using namespace schema;
@@ -16,266 +19,873 @@ using namespace web::http;
 
 const std::string ACCESS_TOKEN = std::getenv("ACCESS_TOKEN");
 
-DataAccessLayer::DataAccessLayer(std::string baseURI) : client(U(baseURI))
+std::chrono::milliseconds longestTimeout(const DataAccessConfig &config)
 {
+    std::chrono::milliseconds longest = config.requestTimeout;
+    for (auto &timeout : config.endpointTimeouts)
+    {
+        longest = std::max(longest, timeout.second);
+    }
+    return longest;
 }
 
-std::vector<Ship> extractShips(json::value &response)
+bool isUnavailable(int statusCode)
 {
-    json::array jsonArray = response.as_array();
-    std::vector<Ship> ships;
-    for (auto jsonShip : jsonArray)
+    // a 503 turns the request away before the game sees it, so even an action is safe to send again.
+    // after a 502 or 504 the gateway gave up on an upstream that may already have run the action
+    return statusCode == 503;
+}
+
+DataAccessLayer::DataAccessLayer(std::string baseURI, DataAccessConfig config)
+    : connectionPool(baseURI, config.connections, longestTimeout(config)), requestTemplates(ACCESS_TOKEN), requestScheduler(config.requestsPerSecond, config.burst, config.laneBudgets), delayQueue(requestScheduler), logger("DAL"),
+      requestObserver(config.requestObserver), trafficRecorder(config.trafficRecorder), trafficReplayer(config.trafficReplayer), retryPolicy(config.retryPolicy),
+      circuitBreaker(config.breakerThreshold, config.breakerPause, config.breakerMaxPause)
+{
+    for (int endpoint = 0; endpoint < metrics::ENDPOINTS; endpoint++)
     {
-        Ship ship(jsonShip);
-        ships.push_back(ship);
+        auto timeout = config.endpointTimeouts.find((metrics::Endpoint)endpoint);
+        timeouts[endpoint] = timeout != config.endpointTimeouts.end() ? timeout->second : config.requestTimeout;
     }
-    return ships;
 }
 
-std::vector<Ship> DataAccessLayer::getShips()
+template <typename T>
+pplx::task<std::vector<T>> collectPages(std::function<pplx::task<Page<T>>(int, bool)> fetchPage)
 {
-    http_request request(methods::GET);
-    request.headers().add(U("Authorization"), U("Bearer ") + U(ACCESS_TOKEN));
-    request.set_request_uri(U("/my/ships"));
+    // the first page tells how many there are, the rest are requested from a continuation
+    // so they are queued and admitted one at a time rather than each holding a pplx thread
+    return fetchPage(1, false)
+        .then([fetchPage](const Page<T> &first)
+              {
+                  std::vector<pplx::task<Page<T>>> rest;
+                  for (int page = 2; (page - 1) * PAGE_LIMIT < first.total; page++)
+                  {
+                      rest.push_back(fetchPage(page, true));
+                  }
+                  if (rest.empty())
+                  {
+                      return pplx::task_from_result(first.items);
+                  }
+                  return pplx::when_all(rest.begin(), rest.end())
+                      .then([first](const std::vector<Page<T>> &pages)
+                            {
+                                std::vector<T> items = first.items;
+                                for (auto &page : pages)
+                                {
+                                    items.insert(items.end(), page.items.begin(), page.items.end());
+                                }
+                                return items; }); });
+}
 
-    json::value response = sendRequest(request);
-    return extractShips(response.at(U("data")));
+template <typename T>
+Page<T> extractPage(const json::value &response)
+{
+    Page<T> result;
+    for (const auto &item : response.at(U("data")).as_array())
+    {
+        result.items.emplace_back(item);
+    }
+    result.total = response.at(U("meta")).at(U("total")).as_integer();
+    return result;
 }
 
-ExtractResponse DataAccessLayer::mine(const std::string &shipSymbol)
+std::vector<Ship> DataAccessLayer::getShips(Priority priority)
 {
-    log(fmt::format("Mining with {}...", shipSymbol));
+    return getShipsAsync(priority).get();
+}
 
-    http_request request(methods::POST);
-    request.headers().add(U("Authorization"), U("Bearer ") + U(ACCESS_TOKEN));
-    request.set_request_uri(U("/my/ships/" + shipSymbol + "/extract"));
+pplx::task<std::vector<Ship>> DataAccessLayer::getShipsAsync(Priority priority)
+{
+    return collectPages<Ship>([this, priority](int page, bool queued)
+                              { return getShipsPageAsync(page, priority, queued); });
+}
 
-    json::value response = sendRequest(request);
-    checkAndThrowError(response);
+pplx::task<Page<Ship>> DataAccessLayer::getShipsPageAsync(int page, Priority priority, bool queued)
+{
+    http_request request = requestTemplates.make(methods::GET, RequestTemplates::ships(page));
 
-    log(fmt::format("Mined with {}.", shipSymbol));
-    return ExtractResponse(response.at(U("data")));
+    return (queued ? queueRequestAsync(metrics::GET_SHIPS, request, NO_BODY, priority) : sendRequestAsync(metrics::GET_SHIPS, request, NO_BODY, priority))
+        .then([this](const json::value &response)
+              {
+                  checkAndThrowError(response);
+                  return extractPage<Ship>(response); });
 }
 
-Cargo DataAccessLayer::getShipCargo(const std::string &shipSymbol)
+ExtractResponse DataAccessLayer::mine(const std::string &shipSymbol, Priority priority)
 {
-    log(fmt::format("Getting ship cargo for {}...", shipSymbol));
+    return mineAsync(shipSymbol, priority).get();
+}
 
-    http_request request(methods::GET);
-    request.headers().add(U("Authorization"), U("Bearer ") + U(ACCESS_TOKEN));
-    request.set_request_uri(U("/my/ships/" + shipSymbol + "/cargo"));
+pplx::task<ExtractResponse> DataAccessLayer::mineAsync(const std::string &shipSymbol, Priority priority)
+{
+    return tryMineAsync(shipSymbol, priority)
+        .then([](const Result<ExtractResponse> &result)
+              { return result.value(); });
+}
 
-    json::value response = sendRequest(request);
-    checkAndThrowError(response);
+Result<ExtractResponse> DataAccessLayer::tryMine(const std::string &shipSymbol, Priority priority)
+{
+    return tryMineAsync(shipSymbol, priority).get();
+}
 
-    log(fmt::format("Got ship cargo for {}.", shipSymbol));
-    return Cargo(response.at(U("data")));
+pplx::task<Result<ExtractResponse>> DataAccessLayer::tryMineAsync(const std::string &shipSymbol, Priority priority)
+{
+    logger.debug("Mining with {}...", shipSymbol);
+
+    http_request request = requestTemplates.make(methods::POST, requestTemplates.ship(shipSymbol).extract);
+
+    return sendRequestAsync(metrics::EXTRACT, request, NO_BODY, priority)
+        .then([this, shipSymbol](const json::value &response)
+              {
+                  if (hasGameError(response))
+                  {
+                      return Result<ExtractResponse>(GameError(response.at(U("error"))));
+                  }
+                  checkAndThrowError(response);
+                  logger.debug("Mined with {}.", shipSymbol);
+                  return Result<ExtractResponse>(ExtractResponse(response.at(U("data")))); });
 }
 
-SellResponse DataAccessLayer::sell(const std::string &shipSymbol, const std::string &tradeSymbol, int unit)
+Cargo DataAccessLayer::getShipCargo(const std::string &shipSymbol, Priority priority)
 {
-    log(fmt::format("Selling cargo for {}, {}x {}...", shipSymbol, unit, tradeSymbol));
+    return getShipCargoAsync(shipSymbol, priority).get();
+}
 
-    json::value payload;
-    payload["symbol"] = json::value::string(tradeSymbol);
-    payload["units"] = json::value::number(unit);
+pplx::task<Cargo> DataAccessLayer::getShipCargoAsync(const std::string &shipSymbol, Priority priority)
+{
+    logger.debug("Getting ship cargo for {}...", shipSymbol);
 
-    http_request request(methods::POST);
-    request.headers().add(U("Authorization"), U("Bearer ") + U(ACCESS_TOKEN));
-    request.set_request_uri(U("/my/ships/" + shipSymbol + "/sell"));
+    http_request request = requestTemplates.make(methods::GET, requestTemplates.ship(shipSymbol).cargo);
 
-    json::value response = sendRequest(request, payload);
-    checkAndThrowError(response);
+    return sendRequestAsync(metrics::GET_CARGO, request, NO_BODY, priority)
+        .then([this, shipSymbol](const json::value &response)
+              {
+                  checkAndThrowError(response);
+                  logger.debug("Got ship cargo for {}.", shipSymbol);
+                  return Cargo(response.at(U("data"))); });
+}
 
-    log(fmt::format("Sold cargo for {}, {}x {}.", shipSymbol, unit, tradeSymbol));
-    return SellResponse(response.at(U("data")));
+SellResponse DataAccessLayer::sell(const std::string &shipSymbol, const std::string &tradeSymbol, int unit, Priority priority)
+{
+    return sellAsync(shipSymbol, tradeSymbol, unit, priority).get();
 }
 
-NavResponse DataAccessLayer::navigate(const std::string &shipSymbol, const std::string &destinationSymbol)
+pplx::task<SellResponse> DataAccessLayer::sellAsync(const std::string &shipSymbol, const std::string &tradeSymbol, int unit, Priority priority)
 {
-    log(fmt::format("Navigating {} to {}...", shipSymbol, destinationSymbol));
+    return trySellAsync(shipSymbol, tradeSymbol, unit, priority)
+        .then([](const Result<SellResponse> &result)
+              { return result.value(); });
+}
 
-    json::value payload;
-    payload["waypointSymbol"] = json::value::string(destinationSymbol);
+Result<SellResponse> DataAccessLayer::trySell(const std::string &shipSymbol, const std::string &tradeSymbol, int unit, Priority priority)
+{
+    return trySellAsync(shipSymbol, tradeSymbol, unit, priority).get();
+}
 
-    http_request request(methods::POST);
-    request.headers().add(U("Authorization"), U("Bearer ") + U(ACCESS_TOKEN));
-    request.set_request_uri(U("/my/ships/" + shipSymbol + "/navigate"));
+pplx::task<Result<SellResponse>> DataAccessLayer::trySellAsync(const std::string &shipSymbol, const std::string &tradeSymbol, int unit, Priority priority)
+{
+    logger.debug("Selling cargo for {}, {}x {}...", shipSymbol, unit, tradeSymbol);
+
+    http_request request = requestTemplates.make(methods::POST, requestTemplates.ship(shipSymbol).sell);
+
+    return sendRequestAsync(metrics::SELL, request, RequestTemplates::sellPayload(tradeSymbol, unit), priority)
+        .then([this, shipSymbol, tradeSymbol, unit](const json::value &response)
+              {
+                  if (hasGameError(response))
+                  {
+                      return Result<SellResponse>(GameError(response.at(U("error"))));
+                  }
+                  checkAndThrowError(response);
+                  logger.debug("Sold cargo for {}, {}x {}.", shipSymbol, unit, tradeSymbol);
+                  return Result<SellResponse>(SellResponse(response.at(U("data")))); });
+}
+
+NavResponse DataAccessLayer::navigate(const std::string &shipSymbol, const std::string &destinationSymbol, Priority priority)
+{
+    return navigateAsync(shipSymbol, destinationSymbol, priority).get();
+}
+
+pplx::task<NavResponse> DataAccessLayer::navigateAsync(const std::string &shipSymbol, const std::string &destinationSymbol, Priority priority)
+{
+    return tryNavigateAsync(shipSymbol, destinationSymbol, priority)
+        .then([](const Result<NavResponse> &result)
+              { return result.value(); });
+}
+
+Result<NavResponse> DataAccessLayer::tryNavigate(const std::string &shipSymbol, const std::string &destinationSymbol, Priority priority)
+{
+    return tryNavigateAsync(shipSymbol, destinationSymbol, priority).get();
+}
+
+pplx::task<Result<NavResponse>> DataAccessLayer::tryNavigateAsync(const std::string &shipSymbol, const std::string &destinationSymbol, Priority priority)
+{
+    logger.debug("Navigating {} to {}...", shipSymbol, destinationSymbol);
+
+    http_request request = requestTemplates.make(methods::POST, requestTemplates.ship(shipSymbol).navigate);
+
+    return sendRequestAsync(metrics::NAVIGATE, request, RequestTemplates::navigatePayload(destinationSymbol), priority)
+        .then([this, shipSymbol, destinationSymbol](const json::value &response)
+              {
+                  if (hasGameError(response))
+                  {
+                      return Result<NavResponse>(GameError(response.at(U("error"))));
+                  }
+                  checkAndThrowError(response);
+                  logger.debug("Navigated {} to {}.", shipSymbol, destinationSymbol);
+                  return Result<NavResponse>(NavResponse(response.at(U("data")))); });
+}
 
-    json::value response = sendRequest(request, payload);
-    checkAndThrowError(response);
+DeliverResponse DataAccessLayer::deliverContract(
+    const std::string &contractId,
+    const std::string &shipSymbol,
+    const std::string &tradeSymbol,
+    int unit,
+    Priority priority)
+{
+    return deliverContractAsync(contractId, shipSymbol, tradeSymbol, unit, priority).get();
+}
 
-    log(fmt::format("Navigated {} to {}.", shipSymbol, destinationSymbol));
-    return NavResponse(response.at(U("data")));
+pplx::task<DeliverResponse> DataAccessLayer::deliverContractAsync(
+    const std::string &contractId,
+    const std::string &shipSymbol,
+    const std::string &tradeSymbol,
+    int unit,
+    Priority priority)
+{
+    return tryDeliverContractAsync(contractId, shipSymbol, tradeSymbol, unit, priority)
+        .then([](const Result<DeliverResponse> &result)
+              { return result.value(); });
+}
+
+Result<DeliverResponse> DataAccessLayer::tryDeliverContract(
+    const std::string &contractId,
+    const std::string &shipSymbol,
+    const std::string &tradeSymbol,
+    int unit,
+    Priority priority)
+{
+    return tryDeliverContractAsync(contractId, shipSymbol, tradeSymbol, unit, priority).get();
 }
 
-bool DataAccessLayer::deliverContract(
+pplx::task<Result<DeliverResponse>> DataAccessLayer::tryDeliverContractAsync(
     const std::string &contractId,
     const std::string &shipSymbol,
     const std::string &tradeSymbol,
-    int unit)
+    int unit,
+    Priority priority)
 {
-    log(fmt::format("Delivering contract {}, {}x {} by {}...", contractId, unit, tradeSymbol, shipSymbol));
+    logger.debug("Delivering contract {}, {}x {} by {}...", contractId, unit, tradeSymbol, shipSymbol);
+
+    http_request request = requestTemplates.make(methods::POST, requestTemplates.contract(contractId).deliver);
+
+    return sendRequestAsync(metrics::DELIVER_CONTRACT, request, RequestTemplates::deliverPayload(shipSymbol, tradeSymbol, unit), priority)
+        .then([this, contractId, shipSymbol, tradeSymbol, unit](const json::value &response)
+              {
+                  if (hasGameError(response))
+                  {
+                      return Result<DeliverResponse>(GameError(response.at(U("error"))));
+                  }
+                  checkAndThrowError(response);
+                  logger.debug("Delivered contract {}, {}x {} by {}.", contractId, unit, tradeSymbol, shipSymbol);
+                  return Result<DeliverResponse>(DeliverResponse(response.at(U("data")))); });
+}
 
-    json::value payload;
-    payload["shipSymbol"] = json::value::string(shipSymbol);
-    payload["tradeSymbol"] = json::value::string(tradeSymbol);
-    payload["units"] = json::value::number(unit);
+// a batch entry that never throws, so when_all always waits for every request of the batch
+template <typename T>
+struct Settled
+{
+    Result<T> result;
+    std::exception_ptr failure;
+};
 
-    http_request request(methods::POST);
-    request.headers().add(U("Authorization"), U("Bearer ") + U(ACCESS_TOKEN));
-    request.set_request_uri(U("/my/contracts/" + contractId + "/deliver"));
+template <typename T>
+pplx::task<Settled<T>> settle(pplx::task<Result<T>> task)
+{
+    return task.then([](pplx::task<Result<T>> done)
+                     {
+                         Settled<T> settled;
+                         try
+                         {
+                             settled.result = done.get();
+                         }
+                         catch (...)
+                         {
+                             settled.failure = std::current_exception();
+                         }
+                         return settled; });
+}
 
-    json::value response = sendRequest(request, payload);
-    checkAndThrowError(response);
+template <typename T>
+BatchResult<T> reconcile(const std::vector<Settled<T>> &settled, const std::vector<int> &units)
+{
+    BatchResult<T> batch;
+    batch.results.reserve(settled.size());
+    for (size_t i = 0; i < settled.size(); i++)
+    {
+        batch.results.push_back(settled[i].result);
+        if (settled[i].failure)
+        {
+            if (!batch.failure)
+            {
+                batch.failure = settled[i].failure;
+            }
+            continue;
+        }
+        if (!settled[i].result.ok())
+        {
+            continue;
+        }
 
-    log(fmt::format("Delivered contract {}, {}x {} by {}.", contractId, unit, tradeSymbol, shipSymbol));
-    return true;
+        batch.units += units[i];
+        // every request only ever shrinks the cargo, so the smallest snapshot is the one processed last
+        const Cargo &cargo = settled[i].result.value().cargo;
+        if (!batch.hasCargo || cargo.units < batch.cargo.units)
+        {
+            batch.cargo = cargo;
+            batch.hasCargo = true;
+        }
+    }
+    return batch;
 }
 
-bool DataAccessLayer::dock(const std::string &shipSymbol)
+SellBatch DataAccessLayer::trySellBatch(const std::string &shipSymbol, const std::vector<SellOrder> &orders, Priority priority)
 {
-    log(fmt::format("Docking {}...", shipSymbol));
+    return trySellBatchAsync(shipSymbol, orders, priority).get();
+}
 
-    http_request request(methods::POST);
-    request.headers().add(U("Authorization"), U("Bearer ") + U(ACCESS_TOKEN));
-    request.set_request_uri(U("/my/ships/" + shipSymbol + "/dock"));
+pplx::task<SellBatch> DataAccessLayer::trySellBatchAsync(const std::string &shipSymbol, const std::vector<SellOrder> &orders, Priority priority)
+{
+    if (orders.empty())
+    {
+        return pplx::task_from_result(SellBatch());
+    }
 
-    json::value response = sendRequest(request);
-    checkAndThrowError(response);
+    std::vector<pplx::task<Settled<SellResponse>>> tasks;
+    std::vector<int> units;
+    tasks.reserve(orders.size());
+    units.reserve(orders.size());
+    for (auto &order : orders)
+    {
+        tasks.push_back(settle(trySellAsync(shipSymbol, order.tradeSymbol, order.units, priority)));
+        units.push_back(order.units);
+    }
+    return pplx::when_all(tasks.begin(), tasks.end())
+        .then([units](const std::vector<Settled<SellResponse>> &settled)
+              { return reconcile(settled, units); });
+}
 
-    log(fmt::format("Docked {}.", shipSymbol));
-    return true;
+DeliverBatch DataAccessLayer::tryDeliverBatch(const std::string &shipSymbol, const std::vector<DeliverOrder> &orders, Priority priority)
+{
+    return tryDeliverBatchAsync(shipSymbol, orders, priority).get();
 }
 
-bool DataAccessLayer::orbit(const std::string &shipSymbol)
+pplx::task<DeliverBatch> DataAccessLayer::tryDeliverBatchAsync(const std::string &shipSymbol, const std::vector<DeliverOrder> &orders, Priority priority)
 {
-    log(fmt::format("Orbiting {}...", shipSymbol));
+    if (orders.empty())
+    {
+        return pplx::task_from_result(DeliverBatch());
+    }
 
-    http_request request(methods::POST);
-    request.headers().add(U("Authorization"), U("Bearer ") + U(ACCESS_TOKEN));
-    request.set_request_uri(U("/my/ships/" + shipSymbol + "/orbit"));
+    std::vector<pplx::task<Settled<DeliverResponse>>> tasks;
+    std::vector<int> units;
+    tasks.reserve(orders.size());
+    units.reserve(orders.size());
+    for (auto &order : orders)
+    {
+        tasks.push_back(settle(tryDeliverContractAsync(order.contractId, shipSymbol, order.tradeSymbol, order.units, priority)));
+        units.push_back(order.units);
+    }
+    return pplx::when_all(tasks.begin(), tasks.end())
+        .then([units](const std::vector<Settled<DeliverResponse>> &settled)
+              { return reconcile(settled, units); });
+}
 
-    json::value response = sendRequest(request);
-    checkAndThrowError(response);
+bool DataAccessLayer::dock(const std::string &shipSymbol, Priority priority)
+{
+    return dockAsync(shipSymbol, priority).get();
+}
 
-    log(fmt::format("Orbited {}.", shipSymbol));
-    return true;
+pplx::task<bool> DataAccessLayer::dockAsync(const std::string &shipSymbol, Priority priority)
+{
+    return tryDockAsync(shipSymbol, priority)
+        .then([](const Result<bool> &result)
+              { return result.value(); });
+}
+
+Result<bool> DataAccessLayer::tryDock(const std::string &shipSymbol, Priority priority)
+{
+    return tryDockAsync(shipSymbol, priority).get();
+}
+
+pplx::task<Result<bool>> DataAccessLayer::tryDockAsync(const std::string &shipSymbol, Priority priority)
+{
+    logger.debug("Docking {}...", shipSymbol);
+
+    http_request request = requestTemplates.make(methods::POST, requestTemplates.ship(shipSymbol).dock);
+
+    return sendRequestAsync(metrics::DOCK, request, NO_BODY, priority)
+        .then([this, shipSymbol](const json::value &response)
+              {
+                  if (hasGameError(response))
+                  {
+                      return Result<bool>(GameError(response.at(U("error"))));
+                  }
+                  checkAndThrowError(response);
+                  logger.debug("Docked {}.", shipSymbol);
+                  return Result<bool>(true); });
 }
 
-bool DataAccessLayer::refuel(const std::string &shipSymbol)
+bool DataAccessLayer::orbit(const std::string &shipSymbol, Priority priority)
 {
-    log(fmt::format("Refueling {}...", shipSymbol));
+    return orbitAsync(shipSymbol, priority).get();
+}
 
-    http_request request(methods::POST);
-    request.headers().add(U("Authorization"), U("Bearer ") + U(ACCESS_TOKEN));
-    request.set_request_uri(U("/my/ships/" + shipSymbol + "/refuel"));
+pplx::task<bool> DataAccessLayer::orbitAsync(const std::string &shipSymbol, Priority priority)
+{
+    return tryOrbitAsync(shipSymbol, priority)
+        .then([](const Result<bool> &result)
+              { return result.value(); });
+}
 
-    json::value response = sendRequest(request);
-    checkAndThrowError(response);
+Result<bool> DataAccessLayer::tryOrbit(const std::string &shipSymbol, Priority priority)
+{
+    return tryOrbitAsync(shipSymbol, priority).get();
+}
 
-    log(fmt::format("Refueled {}.", shipSymbol));
-    return true;
+pplx::task<Result<bool>> DataAccessLayer::tryOrbitAsync(const std::string &shipSymbol, Priority priority)
+{
+    logger.debug("Orbiting {}...", shipSymbol);
+
+    http_request request = requestTemplates.make(methods::POST, requestTemplates.ship(shipSymbol).orbit);
+
+    return sendRequestAsync(metrics::ORBIT, request, NO_BODY, priority)
+        .then([this, shipSymbol](const json::value &response)
+              {
+                  if (hasGameError(response))
+                  {
+                      return Result<bool>(GameError(response.at(U("error"))));
+                  }
+                  checkAndThrowError(response);
+                  logger.debug("Orbited {}.", shipSymbol);
+                  return Result<bool>(true); });
+}
+
+bool DataAccessLayer::refuel(const std::string &shipSymbol, Priority priority)
+{
+    return refuelAsync(shipSymbol, priority).get();
+}
+
+pplx::task<bool> DataAccessLayer::refuelAsync(const std::string &shipSymbol, Priority priority)
+{
+    return tryRefuelAsync(shipSymbol, priority)
+        .then([](const Result<bool> &result)
+              { return result.value(); });
+}
+
+Result<bool> DataAccessLayer::tryRefuel(const std::string &shipSymbol, Priority priority)
+{
+    return tryRefuelAsync(shipSymbol, priority).get();
+}
+
+pplx::task<Result<bool>> DataAccessLayer::tryRefuelAsync(const std::string &shipSymbol, Priority priority)
+{
+    logger.debug("Refueling {}...", shipSymbol);
+
+    http_request request = requestTemplates.make(methods::POST, requestTemplates.ship(shipSymbol).refuel);
+
+    return sendRequestAsync(metrics::REFUEL, request, NO_BODY, priority)
+        .then([this, shipSymbol](const json::value &response)
+              {
+                  if (hasGameError(response))
+                  {
+                      return Result<bool>(GameError(response.at(U("error"))));
+                  }
+                  checkAndThrowError(response);
+                  logger.debug("Refueled {}.", shipSymbol);
+                  return Result<bool>(true); });
+}
+
+std::vector<Contract> DataAccessLayer::getContracts(Priority priority)
+{
+    return getContractsAsync(priority).get();
+}
+
+pplx::task<std::vector<Contract>> DataAccessLayer::getContractsAsync(Priority priority)
+{
+    logger.debug("Getting contracts...");
+
+    // fulfilled contracts stay listed, new offers can be on any page
+    return collectPages<Contract>([this, priority](int page, bool queued)
+                                  { return getContractsPageAsync(page, priority, queued); })
+        .then([this](const std::vector<Contract> &contracts)
+              {
+                  logger.debug("Got {} contracts.", contracts.size());
+                  return contracts; });
+}
+
+pplx::task<Page<Contract>> DataAccessLayer::getContractsPageAsync(int page, Priority priority, bool queued)
+{
+    http_request request = requestTemplates.make(methods::GET, RequestTemplates::contracts(page));
+
+    return (queued ? queueRequestAsync(metrics::GET_CONTRACTS, request, NO_BODY, priority) : sendRequestAsync(metrics::GET_CONTRACTS, request, NO_BODY, priority))
+        .then([this](const json::value &response)
+              {
+                  checkAndThrowError(response);
+                  return extractPage<Contract>(response); });
+}
+
+Contract DataAccessLayer::acceptContract(const std::string &contractId, Priority priority)
+{
+    return acceptContractAsync(contractId, priority).get();
+}
+
+pplx::task<Contract> DataAccessLayer::acceptContractAsync(const std::string &contractId, Priority priority)
+{
+    logger.debug("Accepting contract {}...", contractId);
+
+    http_request request = requestTemplates.make(methods::POST, requestTemplates.contract(contractId).accept);
+
+    return sendRequestAsync(metrics::ACCEPT_CONTRACT, request, NO_BODY, priority)
+        .then([this, contractId](const json::value &response)
+              {
+                  checkAndThrowError(response);
+                  logger.debug("Accepted contract {}.", contractId);
+                  return Contract(response.at(U("data")).at(U("contract"))); });
+}
+
+Contract DataAccessLayer::fulfillContract(const std::string &contractId, Priority priority)
+{
+    return fulfillContractAsync(contractId, priority).get();
+}
+
+pplx::task<Contract> DataAccessLayer::fulfillContractAsync(const std::string &contractId, Priority priority)
+{
+    logger.debug("Fulfilling contract {}...", contractId);
+
+    http_request request = requestTemplates.make(methods::POST, requestTemplates.contract(contractId).fulfill);
+
+    return sendRequestAsync(metrics::FULFILL_CONTRACT, request, NO_BODY, priority)
+        .then([this, contractId](const json::value &response)
+              {
+                  checkAndThrowError(response);
+                  logger.debug("Fulfilled contract {}.", contractId);
+                  return Contract(response.at(U("data")).at(U("contract"))); });
+}
+
+std::vector<Waypoint> DataAccessLayer::getWaypoints(const std::string &systemSymbol, Priority priority)
+{
+    return getWaypointsAsync(systemSymbol, priority).get();
+}
+
+pplx::task<std::vector<Waypoint>> DataAccessLayer::getWaypointsAsync(const std::string &systemSymbol, Priority priority)
+{
+    logger.debug("Getting waypoints of {}...", systemSymbol);
+
+    return collectPages<Waypoint>([this, systemSymbol, priority](int page, bool queued)
+                                  { return getWaypointsPageAsync(systemSymbol, page, priority, queued); })
+        .then([this, systemSymbol](const std::vector<Waypoint> &waypoints)
+              {
+                  logger.debug("Got {} waypoints of {}.", waypoints.size(), systemSymbol);
+                  return waypoints; });
+}
+
+pplx::task<Page<Waypoint>> DataAccessLayer::getWaypointsPageAsync(const std::string &systemSymbol, int page, Priority priority, bool queued)
+{
+    http_request request = requestTemplates.make(methods::GET, RequestTemplates::waypoints(systemSymbol, page));
+
+    return (queued ? queueRequestAsync(metrics::GET_WAYPOINTS, request, NO_BODY, priority) : sendRequestAsync(metrics::GET_WAYPOINTS, request, NO_BODY, priority))
+        .then([this](const json::value &response)
+              {
+                  checkAndThrowError(response);
+                  return extractPage<Waypoint>(response); });
+}
+
+Nav DataAccessLayer::setFlightMode(const std::string &shipSymbol, const std::string &flightMode, Priority priority)
+{
+    return setFlightModeAsync(shipSymbol, flightMode, priority).get();
+}
+
+pplx::task<Nav> DataAccessLayer::setFlightModeAsync(const std::string &shipSymbol, const std::string &flightMode, Priority priority)
+{
+    logger.debug("Setting flight mode of {} to {}...", shipSymbol, flightMode);
+
+    http_request request = requestTemplates.make(methods::PATCH, requestTemplates.ship(shipSymbol).nav);
+
+    return sendRequestAsync(metrics::SET_FLIGHT_MODE, request, RequestTemplates::flightModePayload(flightMode), priority)
+        .then([this, shipSymbol, flightMode](const json::value &response)
+              {
+                  checkAndThrowError(response);
+                  logger.debug("Set flight mode of {} to {}.", shipSymbol, flightMode);
+                  return Nav(response.at(U("data"))); });
+}
+
+Market DataAccessLayer::getMarket(const std::string &systemSymbol, const std::string &waypointSymbol, Priority priority)
+{
+    return getMarketAsync(systemSymbol, waypointSymbol, priority).get();
+}
+
+pplx::task<Market> DataAccessLayer::getMarketAsync(const std::string &systemSymbol, const std::string &waypointSymbol, Priority priority)
+{
+    logger.debug("Getting market at {}...", waypointSymbol);
+
+    http_request request = requestTemplates.make(methods::GET, requestTemplates.market(systemSymbol, waypointSymbol));
+
+    return sendRequestAsync(metrics::GET_MARKET, request, NO_BODY, priority)
+        .then([this, waypointSymbol](const json::value &response)
+              {
+                  checkAndThrowError(response);
+                  logger.debug("Got market at {}.", waypointSymbol);
+                  return Market(response.at(U("data"))); });
+}
+
+std::vector<ConnectionStats> DataAccessLayer::getConnectionStats() const
+{
+    return connectionPool.getStats();
+}
+
+const ServerClock &DataAccessLayer::getServerClock() const
+{
+    return serverClock;
+}
+
+bool DataAccessLayer::hasGameError(const json::value &response)
+{
+    // expected conditions come back as values, checkAndThrowError only sees the rest
+    if (response.has_field(U("error")) && GameError::isExpected(response.at(U("error")).at(U("code")).as_integer()))
+    {
+        logger.debug("Game error in response = {}.", logging::lazy(response));
+        return true;
+    }
+    return false;
 }
 
 bool DataAccessLayer::checkAndThrowError(const json::value &response)
 {
-    log(fmt::format("Checking for error in response = {}...", response.serialize()));
+    logger.debug("Checking for error in response = {}...", logging::lazy(response));
 
     if (response.has_field(U("error")))
     {
         json::value error = response.at(U("error"));
-        log(fmt::format("Error found in response = {}.", error.serialize()));
+        logger.debug("Error found in response = {}.", logging::lazy(error));
 
         int errorCode = error.at(U("code")).as_integer();
         switch (errorCode)
         {
         case ErrorCode::EXTRACT_COOLDOWN:
-            log("Throwing extract cooldown error");
+            logger.debug("Throwing extract cooldown error");
             throw ExtractCooldownException(error);
         case ErrorCode::IN_TRANSIT:
-            log("Throwing in transit error");
+            logger.debug("Throwing in transit error");
             throw InTransitException(error);
         case ErrorCode::FULL_CARGO:
-            log("Throwing full cargo error");
+            logger.debug("Throwing full cargo error");
             throw FullCargoException(error);
         case ErrorCode::EXTRACT_INVALID_WAYPOINT:
-            log("Throwing invalid waypoint error");
+            logger.debug("Throwing invalid waypoint error");
             throw ExtractInvalidWaypointException(error);
         case ErrorCode::NAVIGATE_SAME_LOCATION:
-            log("Throwing same location error");
+            logger.debug("Throwing same location error");
             throw NavigateSameLocationException(error);
         case ErrorCode::NAVIGATE_INSUFFICIENT_FUEL:
-            log("Throwing insufficient fuel error");
+            logger.debug("Throwing insufficient fuel error");
             throw NavigateInsufficientFuelException(error);
         }
-        log("Throwing base error", spdlog::level::critical);
+        logger.critical("Throwing base error");
         throw BaseException(error);
     }
 
-    log(fmt::format("No error found in response = {}.", response.serialize()));
+    logger.debug("No error found in response.");
     return true;
 }
 
-void DataAccessLayer::log(const std::string &message, spdlog::level::level_enum level)
+pplx::task<json::value> DataAccessLayer::sendRequestAsync(metrics::Endpoint endpoint, http_request request, const std::string &body, Priority priority)
 {
-    std::string formattedMessage = fmt::format("DAL: {}", message);
-    switch (level)
-    {
-    case spdlog::level::trace:
-        spdlog::trace(formattedMessage);
-        break;
-    case spdlog::level::debug:
-        spdlog::debug(formattedMessage);
-        break;
-    case spdlog::level::info:
-        spdlog::info(formattedMessage);
-        break;
-    case spdlog::level::warn:
-        spdlog::warn(formattedMessage);
-        break;
-    case spdlog::level::err:
-        spdlog::error(formattedMessage);
-        break;
-    case spdlog::level::critical:
-        spdlog::critical(formattedMessage);
-        break;
-    }
+    // waiting for admission happens on the caller's thread, only the round trip itself is asynchronous
+    requestScheduler.acquire(priority);
+    return dispatchAsync(endpoint, request, body, priority, 1, std::chrono::milliseconds(0));
 }
 
-json::value DataAccessLayer::sendRequest(http_request &request, const web::json::value &body)
+pplx::task<json::value> DataAccessLayer::queueRequestAsync(metrics::Endpoint endpoint, http_request request, const std::string &body, Priority priority)
+{
+    // for requests sent from a continuation, the delay queue waits for the token instead of a pplx thread
+    return delayQueue.admit(std::chrono::milliseconds(0), priority)
+        .then([this, endpoint, request, body, priority]()
+              { return dispatchAsync(endpoint, request, body, priority, 1, std::chrono::milliseconds(0)); });
+}
+
+pplx::task<json::value> DataAccessLayer::dispatchAsync(metrics::Endpoint endpoint, http_request request, const std::string &body, Priority priority,
+                                                       int attempt, std::chrono::milliseconds backoff)
 {
     /* Due to a bug in the cpprestsdk library, a request.body's stream will be consumed
     after the first request. This is a workaround to reinitialize the stream. Otherwise,
     an error will be thrown when the second request is sent occassionally.
     */
+    if (body.empty())
+    {
+        request.set_body("");
+    }
+    else
+    {
+        request.set_body(body, "application/json");
+    }
 
-    while (true)
+    auto sentAt = std::chrono::steady_clock::now();
+    return (trafficReplayer ? replayAsync(endpoint, request, body) : roundTripAsync(endpoint, request, body))
+        .then([this, endpoint, request, body, priority, attempt, backoff, sentAt](pplx::task<json::value> task)
+              {
+                  bool canRetry = attempt < retryPolicy.maxAttempts;
+                  json::value response;
+                  try
+                  {
+                      response = task.get();
+                  }
+                  catch (const std::exception &e)
+                  {
+                      // a timeout or a dropped connection, an action may or may not have gone through
+                      recordFailure(sentAt);
+                      if (!canRetry || request.method() != methods::GET)
+                      {
+                          throw;
+                      }
+                      logger.warn("{} {} failed: {}", request.method(), request.request_uri().to_string(), e.what());
+                      return retryAsync(endpoint, request, body, priority, attempt, backoff);
+                  }
+
+                  if (response.has_field(U("error")))
+                  {
+                      const json::value &error = response.at(U("error"));
+                      int errorCode = error.at(U("code")).as_integer();
+                      // throttling rather than a failure: the server says when to come back, so it is
+                      // retried as often as it takes and leaves the attempts to real failures
+                      if (errorCode == ErrorCode::RATE_LIMITED)
+                      {
+                          logger.debug("Rate limited response = {}.", logging::lazy(response));
+                          int retrymsec = (int)(error.at(U("data")).at(U("retryAfter")).as_double() * 1000.0);
+                          // hold back the whole fleet rather than only this thread, the retry queues up behind it
+                          logger.debug("Holding all requests for {} milliseconds...", retrymsec);
+                          requestScheduler.penalize(std::chrono::milliseconds(retrymsec));
+                          metrics::recordRetry(endpoint);
+                          // the continuation runs on a pplx thread, the wait for a token is left to the delay queue
+                          return delayQueue.admit(std::chrono::milliseconds(0), priority)
+                              .then([this, endpoint, request, body, priority, attempt, backoff]()
+                                    { return dispatchAsync(endpoint, request, body, priority, attempt, backoff); });
+                      }
+                      if (errorCode >= 500 && errorCode < 600)
+                      {
+                          recordFailure(sentAt);
+                          if (canRetry && (request.method() == methods::GET || isUnavailable(errorCode)))
+                          {
+                              logger.warn("{} {} failed with {}.", request.method(), request.request_uri().to_string(), errorCode);
+                              return retryAsync(endpoint, request, body, priority, attempt, backoff);
+                          }
+                          return pplx::task_from_result(response);
+                      }
+                  }
+                  // game errors included, the API itself is working
+                  circuitBreaker.recordSuccess();
+                  return pplx::task_from_result(response); });
+}
+
+pplx::task<json::value> DataAccessLayer::retryAsync(metrics::Endpoint endpoint, http_request request, const std::string &body, Priority priority,
+                                                    int attempt, std::chrono::milliseconds backoff)
+{
+    // the backoff and any breaker pause are waited out by the delay queue, no pplx thread is held meanwhile
+    std::chrono::milliseconds delay = retryPolicy.nextDelay(backoff);
+    logger.debug("Retrying in {} ms, attempt {} of {}...", delay.count(), attempt + 1, retryPolicy.maxAttempts);
+    metrics::recordRetry(endpoint);
+    return delayQueue.admit(delay, priority)
+        .then([this, endpoint, request, body, priority, attempt, delay]()
+              { return dispatchAsync(endpoint, request, body, priority, attempt + 1, delay); });
+}
+
+void DataAccessLayer::recordFailure(std::chrono::steady_clock::time_point sentAt)
+{
+    std::chrono::milliseconds pause = circuitBreaker.recordFailure(sentAt);
+    if (pause.count() > 0)
     {
-        if (body.is_null())
-        {
-            request.set_body("");
-        }
-        else
-        {
-            request.set_body(body);
-        }
-        json::value response = client.request(request).get().extract_json().get();
+        logger.warn("The API looks degraded, holding all requests for {} ms...", pause.count());
+        requestScheduler.penalize(pause);
+    }
+}
 
-        if (response.has_field(U("error")))
-        {
-            json::value error = response.at(U("error"));
-            int errorCode = error.at(U("code")).as_integer();
-            if (errorCode == ErrorCode::RATE_LIMITED)
-            {
-                log(fmt::format("Rate limited response = {}.", response.serialize()));
-                int retrymsec = (int)(error.at(U("data")).at(U("retryAfter")).as_double() * 1000.0);
-                log(fmt::format("Sleeping for {} milliseconds...", retrymsec));
-                std::this_thread::sleep_for(std::chrono::milliseconds(retrymsec));
-                log(fmt::format("Waking up from sleep after {} milliseconds...", retrymsec));
-                continue;
-            }
-        }
-        return response;
+json::value serverError(int statusCode)
+{
+    json::value response;
+    response[U("error")][U("code")] = json::value::number(statusCode);
+    response[U("error")][U("message")] = json::value::string("Server error " + std::to_string(statusCode));
+    // shaped like a game error, which always carries data
+    response[U("error")][U("data")] = json::value::object();
+    return response;
+}
+
+pplx::task<json::value> DataAccessLayer::roundTripAsync(metrics::Endpoint endpoint, const http_request &request, const std::string &body)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto sentAt = std::chrono::system_clock::now();
+    return connectionPool.request(request, timeouts[endpoint])
+        .then([this, endpoint, request, body, start, sentAt](http_response response)
+              {
+                  auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+                  auto date = response.headers().find(U("Date"));
+                  if (date != response.headers().end())
+                  {
+                      try
+                      {
+                          serverClock.observe(ServerClock::parseHttpDate(date->second), std::chrono::seconds(1), sentAt, std::chrono::system_clock::now());
+                      }
+                      catch (const std::invalid_argument &e)
+                      {
+                          logger.debug("{}", e.what());
+                      }
+                  }
+                  metrics::recordRequest(endpoint, response.status_code(), latency);
+                  if (requestObserver)
+                  {
+                      requestObserver(RequestRecord{request.method(), request.request_uri().path(), response.status_code(), latency});
+                  }
+                  // a failing gateway answers with a page rather than JSON, it is turned into an error the caller can read
+                  int statusCode = response.status_code();
+                  pplx::task<json::value> parsed = statusCode >= 500 ? pplx::task_from_result(serverError(statusCode)) : response.extract_json();
+                  if (!trafficRecorder)
+                  {
+                      return parsed;
+                  }
+                  return parsed
+                      .then([this, request, body, start, statusCode, latency](const json::value &json)
+                            {
+                                TrafficEntry entry;
+                                entry.method = request.method();
+                                entry.path = request.request_uri().to_string();
+                                entry.body = body;
+                                entry.statusCode = statusCode;
+                                entry.latency = latency;
+                                entry.serverTime = std::chrono::system_clock::now() + serverClock.getOffset();
+                                entry.response = json;
+                                trafficRecorder->record(entry, start);
+                                return json; }); });
+}
+
+pplx::task<json::value> DataAccessLayer::replayAsync(metrics::Endpoint endpoint, const http_request &request, const std::string &body)
+{
+    TrafficEntry entry;
+    if (!trafficReplayer->next(request.method(), request.request_uri().to_string(), body, entry))
+    {
+        // surfaces like any other unexpected error, the caller decides whether to go on
+        json::value response;
+        response[U("error")][U("code")] = json::value::number(404);
+        response[U("error")][U("message")] = json::value::string("No recorded response for " + request.method() + " " + request.request_uri().to_string());
+        response[U("error")][U("data")] = json::value::object();
+        return pplx::task_from_result(response);
     }
-}
\ No newline at end of file
+
+    // the recorded latency, shortened like the rest of the recording, is waited out on a timer
+    std::chrono::microseconds latency = trafficReplayer->getLatency(entry);
+    return delayQueue.after(latency)
+        .then([this, endpoint, request, entry, latency]()
+              {
+                  metrics::recordRequest(endpoint, entry.statusCode, latency);
+                  if (requestObserver)
+                  {
+                      requestObserver(RequestRecord{request.method(), request.request_uri().path(), entry.statusCode, latency});
+                  }
+                  return trafficReplayer->retime(entry); });
+}
@@ -3,37 +3,196 @@
 #include <cpprest/http_client.h>
 #include "spdlog/spdlog.h"
 
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
 #include <vector>
 
 #include "schema.h"
+#include "request_scheduler.h"
+#include "connection_pool.h"
+#include "delay_queue.h"
+#include "request_templates.h"
+#include "result.h"
+#include "batch.h"
+#include "page.h"
+#include "server_clock.h"
+#include "traffic_log.h"
+#include "retry_policy.h"
+#include "logging.h"
+#include "../metrics/metrics.h"
 
 namespace dal
 {
-    static web::json::value NULL_JSON_BODY = web::json::value();
+    static const std::string NO_BODY = "";
+
+    struct RequestRecord
+    {
+        std::string method;
+        std::string path;
+        int statusCode;
+        // from leaving the scheduler until the response headers arrived
+        std::chrono::microseconds latency;
+    };
+
+    typedef std::function<void(const RequestRecord &)> RequestObserver;
+
+    struct DataAccessConfig
+    {
+        // limits are shared by every ship, SpaceTraders allows 2 requests per second plus short bursts
+        double requestsPerSecond = 2.0;
+        int burst = 10;
+        // tokens each priority lane may take per round while lower lanes are waiting
+        int laneBudgets[PRIORITY_LANES] = {6, 3, 1};
+        // persistent http clients requests are spread over
+        int connections = 4;
+        // called on a pplx thread after every round trip, including rate limited ones
+        RequestObserver requestObserver;
+        // every round trip is appended to the recording when set
+        std::shared_ptr<TrafficRecorder> trafficRecorder;
+        // when set, responses come from a recording and nothing goes over the network
+        std::shared_ptr<TrafficReplayer> trafficReplayer;
+        // for timeouts, dropped connections and 5xx, a POST or PATCH is only sent again after a 503
+        RetryPolicy retryPolicy;
+        std::chrono::milliseconds requestTimeout = std::chrono::seconds(10);
+        // the listings can take longer than a single action
+        std::map<metrics::Endpoint, std::chrono::milliseconds> endpointTimeouts = {
+            {metrics::GET_SHIPS, std::chrono::seconds(30)}, {metrics::GET_WAYPOINTS, std::chrono::seconds(30)}};
+        // this many failures in a row hold back the whole fleet, for longer each time the API is still down
+        int breakerThreshold = 5;
+        std::chrono::milliseconds breakerPause = std::chrono::seconds(5);
+        std::chrono::milliseconds breakerMaxPause = std::chrono::seconds(60);
+    };
 
     class DataAccessLayer
     {
     public:
-        DataAccessLayer(std::string baseURI);
-        std::vector<schema::Ship> getShips();
-
-        schema::ExtractResponse mine(const std::string &shipSymbol);
-        schema::Cargo getShipCargo(const std::string &shipSymbol);
-        schema::SellResponse sell(const std::string &shipSymbol, const std::string &tradeSymbol, int);
-        schema::NavResponse navigate(const std::string &shipSymbol, const std::string &destinationSymbol);
-        bool deliverContract(
+        DataAccessLayer(std::string baseURI, DataAccessConfig config = DataAccessConfig());
+        std::vector<schema::Ship> getShips(Priority priority = NORMAL);
+        pplx::task<std::vector<schema::Ship>> getShipsAsync(Priority priority = NORMAL);
+
+        // the try variants return expected game errors as values, the others throw them
+        schema::ExtractResponse mine(const std::string &shipSymbol, Priority priority = NORMAL);
+        pplx::task<schema::ExtractResponse> mineAsync(const std::string &shipSymbol, Priority priority = NORMAL);
+        Result<schema::ExtractResponse> tryMine(const std::string &shipSymbol, Priority priority = NORMAL);
+        pplx::task<Result<schema::ExtractResponse>> tryMineAsync(const std::string &shipSymbol, Priority priority = NORMAL);
+        schema::Cargo getShipCargo(const std::string &shipSymbol, Priority priority = NORMAL);
+        pplx::task<schema::Cargo> getShipCargoAsync(const std::string &shipSymbol, Priority priority = NORMAL);
+        schema::SellResponse sell(const std::string &shipSymbol, const std::string &tradeSymbol, int, Priority priority = NORMAL);
+        pplx::task<schema::SellResponse> sellAsync(const std::string &shipSymbol, const std::string &tradeSymbol, int, Priority priority = NORMAL);
+        Result<schema::SellResponse> trySell(const std::string &shipSymbol, const std::string &tradeSymbol, int, Priority priority = NORMAL);
+        pplx::task<Result<schema::SellResponse>> trySellAsync(const std::string &shipSymbol, const std::string &tradeSymbol, int, Priority priority = NORMAL);
+        schema::NavResponse navigate(const std::string &shipSymbol, const std::string &destinationSymbol, Priority priority = NORMAL);
+        pplx::task<schema::NavResponse> navigateAsync(const std::string &shipSymbol, const std::string &destinationSymbol, Priority priority = NORMAL);
+        Result<schema::NavResponse> tryNavigate(const std::string &shipSymbol, const std::string &destinationSymbol, Priority priority = NORMAL);
+        pplx::task<Result<schema::NavResponse>> tryNavigateAsync(const std::string &shipSymbol, const std::string &destinationSymbol, Priority priority = NORMAL);
+        schema::DeliverResponse deliverContract(
             const std::string &contractId,
             const std::string &shipSymbol,
             const std::string &tradeSymbol,
-            int units);
-        bool dock(const std::string &shipSymbol);
-        bool orbit(const std::string &shipSymbol);
-        bool refuel(const std::string &shipSymbol);
+            int units,
+            Priority priority = NORMAL);
+        pplx::task<schema::DeliverResponse> deliverContractAsync(
+            const std::string &contractId,
+            const std::string &shipSymbol,
+            const std::string &tradeSymbol,
+            int units,
+            Priority priority = NORMAL);
+        Result<schema::DeliverResponse> tryDeliverContract(
+            const std::string &contractId,
+            const std::string &shipSymbol,
+            const std::string &tradeSymbol,
+            int units,
+            Priority priority = NORMAL);
+        pplx::task<Result<schema::DeliverResponse>> tryDeliverContractAsync(
+            const std::string &contractId,
+            const std::string &shipSymbol,
+            const std::string &tradeSymbol,
+            int units,
+            Priority priority = NORMAL);
+        // every order of a batch is in flight at once, the rate limit still applies to each of them
+        SellBatch trySellBatch(const std::string &shipSymbol, const std::vector<SellOrder> &orders, Priority priority = NORMAL);
+        pplx::task<SellBatch> trySellBatchAsync(const std::string &shipSymbol, const std::vector<SellOrder> &orders, Priority priority = NORMAL);
+        DeliverBatch tryDeliverBatch(const std::string &shipSymbol, const std::vector<DeliverOrder> &orders, Priority priority = NORMAL);
+        pplx::task<DeliverBatch> tryDeliverBatchAsync(const std::string &shipSymbol, const std::vector<DeliverOrder> &orders, Priority priority = NORMAL);
+        bool dock(const std::string &shipSymbol, Priority priority = NORMAL);
+        pplx::task<bool> dockAsync(const std::string &shipSymbol, Priority priority = NORMAL);
+        Result<bool> tryDock(const std::string &shipSymbol, Priority priority = NORMAL);
+        pplx::task<Result<bool>> tryDockAsync(const std::string &shipSymbol, Priority priority = NORMAL);
+        bool orbit(const std::string &shipSymbol, Priority priority = NORMAL);
+        pplx::task<bool> orbitAsync(const std::string &shipSymbol, Priority priority = NORMAL);
+        Result<bool> tryOrbit(const std::string &shipSymbol, Priority priority = NORMAL);
+        pplx::task<Result<bool>> tryOrbitAsync(const std::string &shipSymbol, Priority priority = NORMAL);
+        bool refuel(const std::string &shipSymbol, Priority priority = NORMAL);
+        pplx::task<bool> refuelAsync(const std::string &shipSymbol, Priority priority = NORMAL);
+        Result<bool> tryRefuel(const std::string &shipSymbol, Priority priority = NORMAL);
+        pplx::task<Result<bool>> tryRefuelAsync(const std::string &shipSymbol, Priority priority = NORMAL);
+
+        std::vector<schema::Contract> getContracts(Priority priority = NORMAL);
+        pplx::task<std::vector<schema::Contract>> getContractsAsync(Priority priority = NORMAL);
+        schema::Contract acceptContract(const std::string &contractId, Priority priority = NORMAL);
+        pplx::task<schema::Contract> acceptContractAsync(const std::string &contractId, Priority priority = NORMAL);
+        schema::Contract fulfillContract(const std::string &contractId, Priority priority = NORMAL);
+        pplx::task<schema::Contract> fulfillContractAsync(const std::string &contractId, Priority priority = NORMAL);
+        // the pages after the first are queued once it has told how many there are, then admitted one at a time
+        std::vector<schema::Waypoint> getWaypoints(const std::string &systemSymbol, Priority priority = NORMAL);
+        pplx::task<std::vector<schema::Waypoint>> getWaypointsAsync(const std::string &systemSymbol, Priority priority = NORMAL);
+        schema::Nav setFlightMode(const std::string &shipSymbol, const std::string &flightMode, Priority priority = NORMAL);
+        pplx::task<schema::Nav> setFlightModeAsync(const std::string &shipSymbol, const std::string &flightMode, Priority priority = NORMAL);
+        schema::Market getMarket(const std::string &systemSymbol, const std::string &waypointSymbol, Priority priority = NORMAL);
+        pplx::task<schema::Market> getMarketAsync(const std::string &systemSymbol, const std::string &waypointSymbol, Priority priority = NORMAL);
+
+        std::vector<ConnectionStats> getConnectionStats() const;
+        const ServerClock &getServerClock() const;
 
     private:
-        web::http::client::http_client client;
+        ConnectionPool connectionPool;
+        RequestTemplates requestTemplates;
+        RequestScheduler requestScheduler;
+        DelayQueue delayQueue;
+        logging::Logger logger;
+        RequestObserver requestObserver;
+        std::shared_ptr<TrafficRecorder> trafficRecorder;
+        std::shared_ptr<TrafficReplayer> trafficReplayer;
+        RetryPolicy retryPolicy;
+        std::chrono::milliseconds timeouts[metrics::ENDPOINTS];
+        CircuitBreaker circuitBreaker;
+        ServerClock serverClock;
+        bool hasGameError(const web::json::value &response);
         bool checkAndThrowError(const web::json::value &response);
-        void log(const std::string &message, spdlog::level::level_enum level = spdlog::level::debug);
-        web::json::value sendRequest(web::http::http_request &request, const web::json::value &body = NULL_JSON_BODY);
+        // a queued page is admitted through the delay queue, for pages requested from a continuation
+        pplx::task<Page<schema::Ship>> getShipsPageAsync(int page, Priority priority, bool queued);
+        pplx::task<Page<schema::Contract>> getContractsPageAsync(int page, Priority priority, bool queued);
+        pplx::task<Page<schema::Waypoint>> getWaypointsPageAsync(const std::string &systemSymbol, int page, Priority priority, bool queued);
+        pplx::task<web::json::value> roundTripAsync(metrics::Endpoint endpoint, const web::http::http_request &request, const std::string &body);
+        pplx::task<web::json::value> replayAsync(metrics::Endpoint endpoint, const web::http::http_request &request, const std::string &body);
+        pplx::task<web::json::value> sendRequestAsync(
+            metrics::Endpoint endpoint,
+            web::http::http_request request,
+            const std::string &body = NO_BODY,
+            Priority priority = NORMAL);
+        // like sendRequestAsync, but safe to call from a continuation since no thread waits for admission
+        pplx::task<web::json::value> queueRequestAsync(
+            metrics::Endpoint endpoint,
+            web::http::http_request request,
+            const std::string &body,
+            Priority priority);
+        // sends a request that has already been admitted and handles its response
+        pplx::task<web::json::value> dispatchAsync(
+            metrics::Endpoint endpoint,
+            web::http::http_request request,
+            const std::string &body,
+            Priority priority,
+            int attempt,
+            std::chrono::milliseconds backoff);
+        pplx::task<web::json::value> retryAsync(
+            metrics::Endpoint endpoint,
+            web::http::http_request request,
+            const std::string &body,
+            Priority priority,
+            int attempt,
+            std::chrono::milliseconds backoff);
+        void recordFailure(std::chrono::steady_clock::time_point sentAt);
     };
 };
\ No newline at end of file
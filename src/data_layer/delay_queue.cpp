@@ -0,0 +1,116 @@
+#include "spdlog/spdlog.h"
+
+#include <stdexcept>
+
+#include "delay_queue.h"
+
+using namespace dal;
+
+DelayQueue::DelayQueue(RequestScheduler &requestScheduler)
+    : p_requestScheduler(&requestScheduler), running(true)
+{
+    timerThread = std::thread(&DelayQueue::timerLoop, this);
+    admissionThread = std::thread(&DelayQueue::admissionLoop, this);
+}
+
+DelayQueue::~DelayQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    timerChanged.notify_one();
+    admissionReady.notify_one();
+    timerThread.join();
+    admissionThread.join();
+
+    // whoever still waits is told rather than left hanging
+    std::runtime_error stopped("The request queue was shut down");
+    while (!timers.empty())
+    {
+        timers.top().event.set_exception(std::make_exception_ptr(stopped));
+        timers.pop();
+    }
+    for (auto &lane : lanes)
+    {
+        for (auto &entry : lane)
+        {
+            entry.event.set_exception(std::make_exception_ptr(stopped));
+        }
+    }
+}
+
+pplx::task<void> DelayQueue::admit(std::chrono::milliseconds delay, Priority priority)
+{
+    return schedule(Entry{std::chrono::steady_clock::now() + delay, priority, true, pplx::task_completion_event<void>()});
+}
+
+pplx::task<void> DelayQueue::after(std::chrono::microseconds delay)
+{
+    return schedule(Entry{std::chrono::steady_clock::now() + delay, BACKGROUND, false, pplx::task_completion_event<void>()});
+}
+
+pplx::task<void> DelayQueue::schedule(Entry entry)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        timers.push(entry);
+    }
+    timerChanged.notify_one();
+    return pplx::create_task(entry.event);
+}
+
+void DelayQueue::timerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running)
+    {
+        if (timers.empty())
+        {
+            timerChanged.wait(lock);
+            continue;
+        }
+        if (timers.top().due > std::chrono::steady_clock::now())
+        {
+            timerChanged.wait_until(lock, timers.top().due);
+            continue;
+        }
+        Entry entry = timers.top();
+        timers.pop();
+        if (entry.admit)
+        {
+            lanes[entry.priority].push_back(entry);
+            admissionReady.notify_one();
+            continue;
+        }
+        lock.unlock();
+        entry.event.set();
+        lock.lock();
+    }
+}
+
+void DelayQueue::admissionLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running)
+    {
+        int lane = 0;
+        while (lane < PRIORITY_LANES && lanes[lane].empty())
+        {
+            lane++;
+        }
+        if (lane == PRIORITY_LANES)
+        {
+            admissionReady.wait(lock);
+            continue;
+        }
+        Entry entry = lanes[lane].front();
+        lanes[lane].pop_front();
+
+        // one at a time, the request scheduler hands out one token at a time anyway
+        lock.unlock();
+        p_requestScheduler->acquire(entry.priority);
+        entry.event.set();
+        lock.lock();
+    }
+}
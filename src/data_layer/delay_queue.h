@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cpprest/http_client.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "request_scheduler.h"
+
+namespace dal
+{
+    /* Admission for requests that are sent again from inside a continuation. Waiting for a token
+    there would hold a pplx thread, the same threads that deliver every response, so the waiting
+    is done here: a timer thread holds each request until its delay is over, then an admission
+    thread takes it through the request scheduler, the highest priority first. Only the returned
+    task is left waiting. Plain delays, like the latency of a replayed response, skip admission.
+    */
+    class DelayQueue
+    {
+    public:
+        DelayQueue(RequestScheduler &requestScheduler);
+        ~DelayQueue();
+        // completes once the delay is over and a token has been taken at the priority
+        pplx::task<void> admit(std::chrono::milliseconds delay, Priority priority);
+        // completes once the delay is over, without a token
+        pplx::task<void> after(std::chrono::microseconds delay);
+
+    private:
+        struct Entry
+        {
+            std::chrono::steady_clock::time_point due;
+            Priority priority;
+            bool admit;
+            pplx::task_completion_event<void> event;
+
+            bool operator>(const Entry &other) const
+            {
+                return due > other.due;
+            }
+        };
+
+        pplx::task<void> schedule(Entry entry);
+        void timerLoop();
+        void admissionLoop();
+
+        RequestScheduler *p_requestScheduler;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> timers;
+        std::deque<Entry> lanes[PRIORITY_LANES];
+        std::mutex mutex;
+        std::condition_variable timerChanged;
+        std::condition_variable admissionReady;
+        bool running;
+        std::thread timerThread;
+        std::thread admissionThread;
+    };
+};
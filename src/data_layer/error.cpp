@@ -11,6 +11,10 @@ BaseException::BaseException(json::value &error)
     code = error.at(U("code")).as_integer();
 }
 
+BaseException::BaseException(const GameError &error) : message(error.message), code(error.code)
+{
+}
+
 const char *BaseException::what() const throw()
 {
     return message.c_str();
@@ -29,6 +33,10 @@ ExtractCooldownException::ExtractCooldownException(json::value &error) : BaseExc
     cooldown = data.at(U("cooldown")).at(U("remainingSeconds")).as_integer();
 }
 
+ExtractCooldownException::ExtractCooldownException(const GameError &error) : BaseException(error), cooldown(error.waitSeconds)
+{
+}
+
 int ExtractCooldownException::getCooldown() const
 {
     return cooldown;
@@ -41,6 +49,11 @@ InTransitException::InTransitException(json::value &error) : BaseException(error
     secondsToArrival = data.at(U("secondsToArrival")).as_integer();
 }
 
+InTransitException::InTransitException(const GameError &error)
+    : BaseException(error), departureSymbol(error.departureSymbol), destinationSymbol(error.destinationSymbol), secondsToArrival(error.waitSeconds)
+{
+}
+
 std::string InTransitException::getDepartureSymbol() const
 {
     return departureSymbol;
@@ -60,16 +73,102 @@ FullCargoException::FullCargoException(json::value &error) : BaseException(error
 {
 }
 
+FullCargoException::FullCargoException(const GameError &error) : BaseException(error)
+{
+}
+
 ExtractInvalidWaypointException::ExtractInvalidWaypointException(json::value &error) : BaseException(error)
 {
 }
 
+ExtractInvalidWaypointException::ExtractInvalidWaypointException(const GameError &error) : BaseException(error)
+{
+}
+
 NavigateSameLocationException::NavigateSameLocationException(json::value &error) : BaseException(error)
 {
 }
 
+NavigateSameLocationException::NavigateSameLocationException(const GameError &error) : BaseException(error)
+{
+}
+
 NavigateInsufficientFuelException::NavigateInsufficientFuelException(json::value &error) : BaseException(error)
 {
     fuelRequired = error.at(U("data")).at(U("fuelRequired")).as_integer();
     fuelAvailable = error.at(U("data")).at(U("fuelAvailable")).as_integer();
-}
\ No newline at end of file
+}
+
+NavigateInsufficientFuelException::NavigateInsufficientFuelException(const GameError &error)
+    : BaseException(error), fuelRequired(error.fuelRequired), fuelAvailable(error.fuelAvailable)
+{
+}
+
+GameError::GameError() : code(0), waitSeconds(0), fuelRequired(0), fuelAvailable(0)
+{
+}
+
+GameError::GameError(const json::value &error) : GameError()
+{
+    code = error.at(U("code")).as_integer();
+    message = error.at(U("message")).as_string();
+    const json::value &data = error.at(U("data"));
+    switch (code)
+    {
+    case ErrorCode::EXTRACT_COOLDOWN:
+        waitSeconds = data.at(U("cooldown")).at(U("remainingSeconds")).as_integer();
+        if (data.at(U("cooldown")).has_field(U("expiration")))
+        {
+            waitUntil = data.at(U("cooldown")).at(U("expiration")).as_string();
+        }
+        break;
+    case ErrorCode::IN_TRANSIT:
+        departureSymbol = data.at(U("departureSymbol")).as_string();
+        destinationSymbol = data.at(U("destinationSymbol")).as_string();
+        waitSeconds = data.at(U("secondsToArrival")).as_integer();
+        if (data.has_field(U("arrival")))
+        {
+            waitUntil = data.at(U("arrival")).as_string();
+        }
+        break;
+    case ErrorCode::NAVIGATE_INSUFFICIENT_FUEL:
+        fuelRequired = data.at(U("fuelRequired")).as_integer();
+        fuelAvailable = data.at(U("fuelAvailable")).as_integer();
+        break;
+    }
+}
+
+bool GameError::isExpected(int code)
+{
+    switch (code)
+    {
+    case ErrorCode::EXTRACT_COOLDOWN:
+    case ErrorCode::IN_TRANSIT:
+    case ErrorCode::FULL_CARGO:
+    case ErrorCode::EXTRACT_INVALID_WAYPOINT:
+    case ErrorCode::NAVIGATE_SAME_LOCATION:
+    case ErrorCode::NAVIGATE_INSUFFICIENT_FUEL:
+        return true;
+    }
+    return false;
+}
+
+void GameError::raise() const
+{
+    switch (code)
+    {
+    case ErrorCode::EXTRACT_COOLDOWN:
+        throw ExtractCooldownException(*this);
+    case ErrorCode::IN_TRANSIT:
+        throw InTransitException(*this);
+    case ErrorCode::FULL_CARGO:
+        throw FullCargoException(*this);
+    case ErrorCode::EXTRACT_INVALID_WAYPOINT:
+        throw ExtractInvalidWaypointException(*this);
+    case ErrorCode::NAVIGATE_SAME_LOCATION:
+        throw NavigateSameLocationException(*this);
+    case ErrorCode::NAVIGATE_INSUFFICIENT_FUEL:
+        throw NavigateInsufficientFuelException(*this);
+    }
+    throw BaseException(*this);
+}
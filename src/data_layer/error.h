@@ -3,6 +3,7 @@
 #include <cpprest/json.h>
 
 #include <exception>
+#include <string>
 
 namespace error
 {
@@ -17,10 +18,34 @@ namespace error
         FULL_CARGO = 4228,
     };
 
+    /* A routine game condition returned as a value by the DAL try* calls instead of being thrown.
+    Every expected code has an exception subclass below, raise() throws that one, so callers of the
+    throwing API see exactly what they did before. Only the fields the automation acts on are kept.
+    */
+    struct GameError
+    {
+        GameError();
+        GameError(const web::json::value &error);
+        static bool isExpected(int code);
+        [[noreturn]] void raise() const;
+
+        int code;
+        std::string message;
+        // cooldown left for EXTRACT_COOLDOWN, seconds to arrival for IN_TRANSIT
+        int waitSeconds;
+        // the same moment as a server timestamp, empty if the response did not carry one
+        std::string waitUntil;
+        std::string departureSymbol;
+        std::string destinationSymbol;
+        int fuelRequired;
+        int fuelAvailable;
+    };
+
     class BaseException : public std::exception
     {
     public:
         BaseException(web::json::value &error);
+        BaseException(const GameError &error);
         virtual const char *what() const throw();
         web::json::value getData() const;
         int getErrorCode() const;
@@ -35,6 +60,7 @@ namespace error
     {
     public:
         ExtractCooldownException(web::json::value &error);
+        ExtractCooldownException(const GameError &error);
         int getCooldown() const;
 
     private:
@@ -45,6 +71,7 @@ namespace error
     {
     public:
         InTransitException(web::json::value &error);
+        InTransitException(const GameError &error);
         std::string getDepartureSymbol() const;
         std::string getDestinationSymbol() const;
         int getSecondsToArrival() const;
@@ -59,24 +86,28 @@ namespace error
     {
     public:
         FullCargoException(web::json::value &error);
+        FullCargoException(const GameError &error);
     };
 
     class ExtractInvalidWaypointException : public BaseException
     {
     public:
         ExtractInvalidWaypointException(web::json::value &error);
+        ExtractInvalidWaypointException(const GameError &error);
     };
 
     class NavigateSameLocationException : public BaseException
     {
     public:
         NavigateSameLocationException(web::json::value &error);
+        NavigateSameLocationException(const GameError &error);
     };
 
     class NavigateInsufficientFuelException : public BaseException
     {
     public:
         NavigateInsufficientFuelException(web::json::value &error);
+        NavigateInsufficientFuelException(const GameError &error);
 
         int fuelRequired;
         int fuelAvailable;
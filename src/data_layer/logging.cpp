@@ -0,0 +1,21 @@
+#include "spdlog/async.h"
+#include "spdlog/sinks/stdout_color_sinks.h"
+
+#include "logging.h"
+
+using namespace logging;
+
+void logging::init(spdlog::level::level_enum level, bool async)
+{
+    if (async)
+    {
+        // writing moves to a background thread, messages are still formatted by the caller
+        spdlog::init_thread_pool(8192, 1);
+        spdlog::set_default_logger(spdlog::stdout_color_mt<spdlog::async_factory>("space-traders"));
+    }
+    spdlog::set_level(level);
+}
+
+Logger::Logger(std::string prefix) : prefix(prefix)
+{
+}
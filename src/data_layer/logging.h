@@ -0,0 +1,94 @@
+#pragma once
+
+// fmt has to come before cpprest, whose U() macro breaks fmt's templates
+#include "spdlog/spdlog.h"
+#include <fmt/core.h>
+#include <cpprest/json.h>
+
+#include <string>
+
+namespace logging
+{
+    void init(spdlog::level::level_enum level, bool async);
+
+    // wraps a JSON value so that serialize() only runs when the message is actually formatted
+    struct LazyJson
+    {
+        const web::json::value &value;
+    };
+
+    inline LazyJson lazy(const web::json::value &value)
+    {
+        return LazyJson{value};
+    }
+
+    class Logger
+    {
+    public:
+        Logger(std::string prefix);
+
+        template <typename... Args>
+        void log(spdlog::level::level_enum level, const char *format, const Args &...args) const
+        {
+            // nothing is formatted unless the default logger would print the message
+            if (!spdlog::should_log(level))
+            {
+                return;
+            }
+            spdlog::log(level, "{}: {}", prefix, fmt::vformat(format, fmt::make_format_args(args...)));
+        }
+
+        template <typename... Args>
+        void trace(const char *format, const Args &...args) const
+        {
+            log(spdlog::level::trace, format, args...);
+        }
+
+        template <typename... Args>
+        void debug(const char *format, const Args &...args) const
+        {
+            log(spdlog::level::debug, format, args...);
+        }
+
+        template <typename... Args>
+        void info(const char *format, const Args &...args) const
+        {
+            log(spdlog::level::info, format, args...);
+        }
+
+        template <typename... Args>
+        void warn(const char *format, const Args &...args) const
+        {
+            log(spdlog::level::warn, format, args...);
+        }
+
+        template <typename... Args>
+        void error(const char *format, const Args &...args) const
+        {
+            log(spdlog::level::err, format, args...);
+        }
+
+        template <typename... Args>
+        void critical(const char *format, const Args &...args) const
+        {
+            log(spdlog::level::critical, format, args...);
+        }
+
+    private:
+        std::string prefix;
+    };
+}
+
+namespace fmt
+{
+    template <>
+    struct formatter<logging::LazyJson> : formatter<string_view>
+    {
+        template <typename FormatContext>
+        auto format(const logging::LazyJson &json, FormatContext &ctx) const -> decltype(ctx.out())
+        {
+            std::string serialized = json.value.serialize();
+            return formatter<string_view>::format(string_view(serialized), ctx);
+        }
+    };
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <vector>
+
+namespace dal
+{
+    // the most items the API returns per page
+    const int PAGE_LIMIT = 20;
+
+    // one page of a listing, total counts the items on every page
+    template <typename T>
+    struct Page
+    {
+        std::vector<T> items;
+        int total = 0;
+    };
+}
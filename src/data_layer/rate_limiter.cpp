@@ -0,0 +1,46 @@
+#include <algorithm>
+#include <thread>
+
+#include "rate_limiter.h"
+
+using namespace dal;
+
+RateLimiter::RateLimiter(double requestsPerSecond, int burst) : theoreticalArrival(0)
+{
+    emissionInterval = (std::int64_t)(1e9 / requestsPerSecond);
+    burstTolerance = emissionInterval * std::max(burst - 1, 0);
+}
+
+void RateLimiter::acquire()
+{
+    // reserve the next slot, then sleep outside of the CAS loop until it is due
+    std::int64_t current = now();
+    std::int64_t arrival = theoreticalArrival.load();
+    std::int64_t admitAt;
+    std::int64_t nextArrival;
+    do
+    {
+        admitAt = std::max(current, arrival - burstTolerance);
+        nextArrival = std::max(arrival, current) + emissionInterval;
+    } while (!theoreticalArrival.compare_exchange_weak(arrival, nextArrival));
+
+    if (admitAt > current)
+    {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(admitAt - current));
+    }
+}
+
+void RateLimiter::penalize(std::chrono::milliseconds retryAfter)
+{
+    // the server told us to back off, so no one gets admitted before retryAfter has passed
+    std::int64_t blockedUntil = now() + std::chrono::duration_cast<std::chrono::nanoseconds>(retryAfter).count() + burstTolerance;
+    std::int64_t arrival = theoreticalArrival.load();
+    while (arrival < blockedUntil && !theoreticalArrival.compare_exchange_weak(arrival, blockedUntil))
+    {
+    }
+}
+
+std::int64_t RateLimiter::now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
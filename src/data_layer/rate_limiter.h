@@ -0,0 +1,26 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace dal
+{
+    class RateLimiter
+    {
+    public:
+        RateLimiter(double requestsPerSecond, int burst);
+        void acquire();
+        void penalize(std::chrono::milliseconds retryAfter);
+
+    private:
+        /* Token bucket expressed as a generic cell rate algorithm: instead of counting tokens,
+        keep the theoretical arrival time of the next request. Each caller reserves its slot
+        with a single CAS, so admission is lock-free and slots are handed out in FIFO order.
+        */
+        std::int64_t now() const;
+        std::int64_t emissionInterval;
+        std::int64_t burstTolerance;
+        std::atomic<std::int64_t> theoreticalArrival;
+    };
+};
@@ -0,0 +1,68 @@
+#include "request_scheduler.h"
+
+using namespace dal;
+
+RequestScheduler::RequestScheduler(double requestsPerSecond, int burst, const int (&laneBudgets)[PRIORITY_LANES])
+    : rateLimiter(requestsPerSecond, burst), nextTicket(0), dispatching(false)
+{
+    for (int lane = 0; lane < PRIORITY_LANES; lane++)
+    {
+        budgets[lane] = laneBudgets[lane] > 0 ? laneBudgets[lane] : 1;
+        remainingBudgets[lane] = budgets[lane];
+    }
+}
+
+void RequestScheduler::acquire(Priority priority)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    std::uint64_t ticket = nextTicket++;
+    lanes[priority].push_back(ticket);
+    laneChanged.wait(lock, [&]
+                     { return !dispatching && selectLane() == priority && lanes[priority].front() == ticket; });
+    lanes[priority].pop_front();
+    remainingBudgets[priority]--;
+    dispatching = true;
+    lock.unlock();
+
+    rateLimiter.acquire();
+
+    lock.lock();
+    dispatching = false;
+    lock.unlock();
+    laneChanged.notify_all();
+}
+
+void RequestScheduler::penalize(std::chrono::milliseconds retryAfter)
+{
+    rateLimiter.penalize(retryAfter);
+}
+
+int RequestScheduler::selectLane()
+{
+    // start a new round once every waiting lane has used up its budget
+    for (int round = 0; round < 2; round++)
+    {
+        bool anyWaiting = false;
+        for (int lane = 0; lane < PRIORITY_LANES; lane++)
+        {
+            if (lanes[lane].empty())
+            {
+                continue;
+            }
+            anyWaiting = true;
+            if (remainingBudgets[lane] > 0)
+            {
+                return lane;
+            }
+        }
+        if (!anyWaiting)
+        {
+            return -1;
+        }
+        for (int lane = 0; lane < PRIORITY_LANES; lane++)
+        {
+            remainingBudgets[lane] = budgets[lane];
+        }
+    }
+    return -1;
+}
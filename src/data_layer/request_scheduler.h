@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+#include "rate_limiter.h"
+
+namespace dal
+{
+    enum Priority
+    {
+        CRITICAL,
+        NORMAL,
+        BACKGROUND,
+    };
+
+    const int PRIORITY_LANES = 3;
+
+    class RequestScheduler
+    {
+    public:
+        RequestScheduler(double requestsPerSecond, int burst, const int (&laneBudgets)[PRIORITY_LANES]);
+        void acquire(Priority priority);
+        void penalize(std::chrono::milliseconds retryAfter);
+
+    private:
+        /* Only one caller at a time waits on the rate limiter, so the lane is chosen again for
+        every token. Higher lanes go first, but each lane may only take its budget of tokens per
+        round while other lanes are waiting, which keeps background requests from starving.
+        */
+        int selectLane();
+        RateLimiter rateLimiter;
+        std::mutex mutex;
+        std::condition_variable laneChanged;
+        std::deque<std::uint64_t> lanes[PRIORITY_LANES];
+        int budgets[PRIORITY_LANES];
+        int remainingBudgets[PRIORITY_LANES];
+        std::uint64_t nextTicket;
+        bool dispatching;
+    };
+};
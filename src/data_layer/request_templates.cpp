@@ -0,0 +1,102 @@
+#include "spdlog/spdlog.h"
+#include <fmt/core.h>
+
+#include "request_templates.h"
+
+using namespace dal;
+using namespace web;
+using namespace web::http;
+
+RequestTemplates::RequestTemplates(const std::string &accessToken)
+    : authorization(U("Bearer ") + U(accessToken))
+{
+}
+
+http_request RequestTemplates::make(const method &method, const uri &path) const
+{
+    http_request request(method);
+    request.headers().add(U("Authorization"), authorization);
+    request.set_request_uri(path);
+    return request;
+}
+
+uri RequestTemplates::ships(int page)
+{
+    return uri(U(fmt::format("/my/ships?limit={}&page={}", PAGE_LIMIT, page)));
+}
+
+const ShipRoutes &RequestTemplates::ship(const std::string &shipSymbol)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<ShipRoutes> &routes = shipRoutes[shipSymbol];
+    if (!routes)
+    {
+        const std::string base = "/my/ships/" + shipSymbol;
+        routes.reset(new ShipRoutes{
+            uri(U(base + "/extract")),
+            uri(U(base + "/cargo")),
+            uri(U(base + "/sell")),
+            uri(U(base + "/navigate")),
+            uri(U(base + "/dock")),
+            uri(U(base + "/orbit")),
+            uri(U(base + "/refuel")),
+            uri(U(base + "/nav"))});
+    }
+    return *routes;
+}
+
+uri RequestTemplates::contracts(int page)
+{
+    return uri(U(fmt::format("/my/contracts?limit={}&page={}", PAGE_LIMIT, page)));
+}
+
+const ContractRoutes &RequestTemplates::contract(const std::string &contractId)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<ContractRoutes> &routes = contractRoutes[contractId];
+    if (!routes)
+    {
+        const std::string base = "/my/contracts/" + contractId;
+        routes.reset(new ContractRoutes{
+            uri(U(base + "/deliver")),
+            uri(U(base + "/accept")),
+            uri(U(base + "/fulfill"))});
+    }
+    return *routes;
+}
+
+const uri &RequestTemplates::market(const std::string &systemSymbol, const std::string &waypointSymbol)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<uri> &path = marketPaths[waypointSymbol];
+    if (!path)
+    {
+        path.reset(new uri(U("/systems/" + systemSymbol + "/waypoints/" + waypointSymbol + "/market")));
+    }
+    return *path;
+}
+
+uri RequestTemplates::waypoints(const std::string &systemSymbol, int page)
+{
+    return uri(U(fmt::format("/systems/{}/waypoints?limit={}&page={}", systemSymbol, PAGE_LIMIT, page)));
+}
+
+std::string RequestTemplates::sellPayload(const std::string &tradeSymbol, int units)
+{
+    return fmt::format(R"({{"symbol":"{}","units":{}}})", tradeSymbol, units);
+}
+
+std::string RequestTemplates::navigatePayload(const std::string &waypointSymbol)
+{
+    return fmt::format(R"({{"waypointSymbol":"{}"}})", waypointSymbol);
+}
+
+std::string RequestTemplates::deliverPayload(const std::string &shipSymbol, const std::string &tradeSymbol, int units)
+{
+    return fmt::format(R"({{"shipSymbol":"{}","tradeSymbol":"{}","units":{}}})", shipSymbol, tradeSymbol, units);
+}
+
+std::string RequestTemplates::flightModePayload(const std::string &flightMode)
+{
+    return fmt::format(R"({{"flightMode":"{}"}})", flightMode);
+}
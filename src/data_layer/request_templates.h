@@ -0,0 +1,64 @@
+#pragma once
+
+#include <fmt/core.h>
+#include <cpprest/http_msg.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "page.h"
+
+namespace dal
+{
+    struct ShipRoutes
+    {
+        web::uri extract;
+        web::uri cargo;
+        web::uri sell;
+        web::uri navigate;
+        web::uri dock;
+        web::uri orbit;
+        web::uri refuel;
+        web::uri nav;
+    };
+
+    struct ContractRoutes
+    {
+        web::uri deliver;
+        web::uri accept;
+        web::uri fulfill;
+    };
+
+    class RequestTemplates
+    {
+    public:
+        /* Everything a request needs that does not change between calls: the Authorization header
+        and the parsed path of every ship, contract and market endpoint, rendered once on first use.
+        Routes are never evicted, a fleet only has so many ships, contracts and markets.
+        */
+        RequestTemplates(const std::string &accessToken);
+        web::http::http_request make(const web::http::method &method, const web::uri &path) const;
+        // pages are not cached, the paths would only pile up once per refresh
+        static web::uri ships(int page);
+        const ShipRoutes &ship(const std::string &shipSymbol);
+        static web::uri contracts(int page);
+        const ContractRoutes &contract(const std::string &contractId);
+        const web::uri &market(const std::string &systemSymbol, const std::string &waypointSymbol);
+        static web::uri waypoints(const std::string &systemSymbol, int page);
+
+        // symbols are upper case letters, digits, '-' and '_', so the payloads need no escaping
+        static std::string sellPayload(const std::string &tradeSymbol, int units);
+        static std::string navigatePayload(const std::string &waypointSymbol);
+        static std::string deliverPayload(const std::string &shipSymbol, const std::string &tradeSymbol, int units);
+        static std::string flightModePayload(const std::string &flightMode);
+
+    private:
+        std::string authorization;
+        std::mutex mutex;
+        std::unordered_map<std::string, std::unique_ptr<ShipRoutes>> shipRoutes;
+        std::unordered_map<std::string, std::unique_ptr<ContractRoutes>> contractRoutes;
+        std::unordered_map<std::string, std::unique_ptr<web::uri>> marketPaths;
+    };
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <utility>
+
+#include "error.h"
+
+namespace dal
+{
+    /* Either the parsed response of a DAL call or the expected game error it ran into. Both are
+    stored side by side, pplx needs a default constructible result and the schema types are cheap
+    to leave empty. Unexpected failures are still thrown.
+    */
+    template <typename T>
+    class Result
+    {
+    public:
+        Result() : hasValue(false) {}
+        Result(T value) : hasValue(true), result(std::move(value)) {}
+        Result(error::GameError gameError) : hasValue(false), gameError(std::move(gameError)) {}
+
+        bool ok() const
+        {
+            return hasValue;
+        }
+
+        // throws the matching exception when the call ended in a game error
+        const T &value() const
+        {
+            if (!hasValue)
+            {
+                gameError.raise();
+            }
+            return result;
+        }
+
+        T &value()
+        {
+            if (!hasValue)
+            {
+                gameError.raise();
+            }
+            return result;
+        }
+
+        const error::GameError &error() const
+        {
+            return gameError;
+        }
+
+    private:
+        bool hasValue;
+        T result;
+        error::GameError gameError;
+    };
+}
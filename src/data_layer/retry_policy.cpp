@@ -0,0 +1,50 @@
+#include "retry_policy.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace dal;
+
+std::chrono::milliseconds RetryPolicy::nextDelay(std::chrono::milliseconds previous) const
+{
+    thread_local std::mt19937 random(std::random_device{}());
+    std::chrono::milliseconds::rep low = baseDelay.count();
+    std::chrono::milliseconds::rep high = 3 * std::max(previous, baseDelay).count();
+    std::uniform_int_distribution<std::chrono::milliseconds::rep> delay(low, high);
+    return std::min(maxDelay, std::chrono::milliseconds(delay(random)));
+}
+
+CircuitBreaker::CircuitBreaker(int failureThreshold, std::chrono::milliseconds pause, std::chrono::milliseconds maxPause)
+    : failureThreshold(failureThreshold), basePause(pause), maxPause(maxPause), pause(pause), failures(0), tripped(false)
+{
+}
+
+void CircuitBreaker::recordSuccess()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    failures = 0;
+    tripped = false;
+    pause = basePause;
+}
+
+std::chrono::milliseconds CircuitBreaker::recordFailure(std::chrono::steady_clock::time_point sentAt)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tripped && sentAt < trippedAt)
+    {
+        return std::chrono::milliseconds(0);
+    }
+    failures++;
+    if (tripped)
+    {
+        // the first request after the pause failed as well
+        pause = std::min(maxPause, 2 * pause);
+    }
+    else if (failures < failureThreshold)
+    {
+        return std::chrono::milliseconds(0);
+    }
+    tripped = true;
+    trippedAt = std::chrono::steady_clock::now();
+    return pause;
+}
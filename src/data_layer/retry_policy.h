@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+
+namespace dal
+{
+    /* How often and how long to wait before a failed request is sent again. Waits follow
+    decorrelated jitter: each is drawn between baseDelay and three times the previous one,
+    capped at maxDelay, so retries of many ships spread out instead of arriving together.
+    */
+    struct RetryPolicy
+    {
+        // including the first one, a rate limited response does not use one up
+        int maxAttempts = 4;
+        std::chrono::milliseconds baseDelay = std::chrono::milliseconds(250);
+        std::chrono::milliseconds maxDelay = std::chrono::seconds(10);
+
+        // previous is zero before the first retry
+        std::chrono::milliseconds nextDelay(std::chrono::milliseconds previous) const;
+    };
+
+    /* Counts consecutive failures of the API as a whole, timeouts, dropped connections and 5xx.
+    After failureThreshold of them in a row it trips and tells the caller to hold every request
+    for a pause. The first result after that decides: a success closes the breaker, a failure
+    trips it again for twice as long, up to maxPause. Failures of requests that were already in
+    flight when it tripped do not count again. Thread safe.
+    */
+    class CircuitBreaker
+    {
+    public:
+        CircuitBreaker(int failureThreshold, std::chrono::milliseconds pause, std::chrono::milliseconds maxPause);
+
+        void recordSuccess();
+        // how long the fleet should hold off, zero while the breaker stays closed
+        std::chrono::milliseconds recordFailure(std::chrono::steady_clock::time_point sentAt);
+
+    private:
+        int failureThreshold;
+        std::chrono::milliseconds basePause;
+        std::chrono::milliseconds maxPause;
+        std::chrono::milliseconds pause;
+        int failures;
+        bool tripped;
+        std::chrono::steady_clock::time_point trippedAt;
+        std::mutex mutex;
+    };
+}
@@ -3,12 +3,12 @@
 
 #include "schema.h"
 
-#include <iomanip>
+#include <algorithm>
 
 using namespace schema;
 using namespace web;
 
-CargoItem::CargoItem(json::value json)
+CargoItem::CargoItem(const json::value &json)
 {
     symbol = json.at(U("symbol")).as_string();
     name = json.at(U("name")).as_string();
@@ -16,17 +16,17 @@ CargoItem::CargoItem(json::value json)
     units = json.at(U("units")).as_integer();
 }
 
-Cargo::Cargo(json::value json)
+Cargo::Cargo(const json::value &json)
 {
     capacity = json.at(U("capacity")).as_integer();
     units = json.at(U("units")).as_integer();
-    inventory = std::vector<CargoItem>();
+    const json::array &items = json.at(U("inventory")).as_array();
+    inventory.reserve(items.size());
     int unitSum = 0;
-    for (auto item : json.at(U("inventory")).as_array())
+    for (const auto &item : items)
     {
-        CargoItem inventoryItem(item);
-        inventory.push_back(inventoryItem);
-        unitSum += inventoryItem.units;
+        inventory.emplace_back(item);
+        unitSum += inventory.back().units;
     }
     if (units != unitSum)
     {
@@ -53,12 +53,13 @@ std::string Cargo::printStat()
     return std::to_string(units) + "/" + std::to_string(capacity) + " (" + std::to_string((int)((float)units / (float)capacity * 100)) + "%)";
 }
 
-Fuel::Fuel(json::value json)
+Fuel::Fuel(const json::value &json)
 {
     current = json.at(U("current")).as_integer();
     capacity = json.at(U("capacity")).as_integer();
-    consumedAmount = json.at(U("consumed")).at(U("amount")).as_integer();
-    timestamp = json.at(U("consumed")).at(U("timestamp")).as_string();
+    const json::value &consumed = json.at(U("consumed"));
+    consumedAmount = consumed.at(U("amount")).as_integer();
+    timestamp = consumed.at(U("timestamp")).as_string();
 }
 
 std::string Fuel::printStat()
@@ -66,18 +67,32 @@ std::string Fuel::printStat()
     return std::to_string(current) + "/" + std::to_string(capacity) + " (" + std::to_string((int)((float)current / (float)capacity * 100)) + "%)";
 }
 
-ShipBasic::ShipBasic(json::value json)
+ShipBasic::ShipBasic(const json::value &json)
 {
     symbol = json.at(U("symbol")).as_string();
-    name = json.at(U("registration")).at(U("name")).as_string();
-    role = json.at(U("registration")).at(U("role")).as_string();
+    const json::value &registration = json.at(U("registration"));
+    name = registration.at(U("name")).as_string();
+    role = registration.at(U("role")).as_string();
 }
 
-Ship::Ship(web::json::value json) : ShipBasic(json), cargo(json.at(U("cargo"))), fuel(json.at(U("fuel")))
+Mount::Mount(const json::value &json)
 {
+    symbol = json.at(U("symbol")).as_string();
+    name = json.at(U("name")).as_string();
+    strength = json.has_field(U("strength")) ? json.at(U("strength")).as_integer() : 0;
+}
+
+Ship::Ship(const web::json::value &json) : ShipBasic(json), cargo(json.at(U("cargo"))), fuel(json.at(U("fuel"))), nav(json.at(U("nav")))
+{
+    const json::array &items = json.at(U("mounts")).as_array();
+    mounts.reserve(items.size());
+    for (const auto &item : items)
+    {
+        mounts.push_back(Mount(item));
+    }
 }
 
-Yield::Yield(json::value json)
+Yield::Yield(const json::value &json)
 {
     symbol = json.at(U("symbol")).as_string();
     units = json.at(U("units")).as_integer();
@@ -88,7 +103,7 @@ std::string Yield::printStat()
     return std::to_string(units) + "x " + symbol;
 }
 
-NavRouteWaypoint::NavRouteWaypoint(json::value json)
+NavRouteWaypoint::NavRouteWaypoint(const json::value &json)
 {
     symbol = json.at(U("symbol")).as_string();
     type = json.at(U("type")).as_string();
@@ -97,24 +112,14 @@ NavRouteWaypoint::NavRouteWaypoint(json::value json)
     y = json.at(U("y")).as_integer();
 }
 
-NavRoute::NavRoute(json::value json)
-    : departure(NavRouteWaypoint(json.at(U("departure")))), destination(NavRouteWaypoint(json.at(U("destination"))))
+NavRoute::NavRoute(const json::value &json)
+    : departure(json.at(U("departure"))), destination(json.at(U("destination")))
 {
     arrival = json.at(U("arrival")).as_string();
     departureTime = json.at(U("departureTime")).as_string();
 }
 
-int NavRoute::getETA()
-{
-    // return the ETA in seconds
-    std::tm tm = {};
-    std::istringstream ss(arrival);
-    ss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%S");
-    std::time_t t = std::mktime(&tm);
-    return (int)std::ceil(std::difftime(t, std::time(nullptr)));
-}
-
-Nav::Nav(json::value json) : route(json.at(U("route")))
+Nav::Nav(const json::value &json) : route(json.at(U("route")))
 {
     systemSymbol = json.at(U("systemSymbol")).as_string();
     waypointSymbol = json.at(U("waypointSymbol")).as_string();
@@ -122,19 +127,133 @@ Nav::Nav(json::value json) : route(json.at(U("route")))
     flightMode = json.at(U("flightMode")).as_string();
 }
 
-ExtractResponse::ExtractResponse(web::json::value json) : cargo(json.at(U("cargo"))), yield(json.at(U("extraction")).at(U("yield")))
+ExtractResponse::ExtractResponse(const web::json::value &json) : cargo(json.at(U("cargo"))), yield(json.at(U("extraction")).at(U("yield")))
+{
+    const json::value &cooldown = json.at(U("cooldown"));
+    cooldownSeconds = cooldown.at(U("remainingSeconds")).as_integer();
+    cooldownExpiration = cooldown.at(U("expiration")).as_string();
+}
+
+SellResponse::SellResponse(const web::json::value &json) : cargo(json.at(U("cargo")))
+{
+    const json::value &transaction = json.at(U("transaction"));
+    waypointSymbol = transaction.at(U("waypointSymbol")).as_string();
+    tradeSymbol = transaction.at(U("tradeSymbol")).as_string();
+    units = transaction.at(U("units")).as_integer();
+    totalPrice = transaction.at(U("totalPrice")).as_integer();
+    pricePerUnit = transaction.at(U("pricePerUnit")).as_integer();
+}
+
+ContractDeliverGood::ContractDeliverGood(const json::value &json)
+{
+    tradeSymbol = json.at(U("tradeSymbol")).as_string();
+    destinationSymbol = json.at(U("destinationSymbol")).as_string();
+    unitsRequired = json.at(U("unitsRequired")).as_integer();
+    unitsFulfilled = json.at(U("unitsFulfilled")).as_integer();
+}
+
+Contract::Contract(const json::value &json)
+{
+    id = json.at(U("id")).as_string();
+    type = json.at(U("type")).as_string();
+    const json::value &terms = json.at(U("terms"));
+    deadline = terms.has_field(U("deadline")) ? terms.at(U("deadline")).as_string() : "";
+    const json::array &items = terms.at(U("deliver")).as_array();
+    deliver.reserve(items.size());
+    for (const auto &item : items)
+    {
+        deliver.push_back(ContractDeliverGood(item));
+    }
+    accepted = json.at(U("accepted")).as_bool();
+    fulfilled = json.at(U("fulfilled")).as_bool();
+}
+
+int Contract::getRemaining(const std::string &tradeSymbol) const
+{
+    int remaining = 0;
+    for (auto &good : deliver)
+    {
+        if (good.tradeSymbol == tradeSymbol)
+        {
+            remaining += std::max(0, good.unitsRequired - good.unitsFulfilled);
+        }
+    }
+    return remaining;
+}
+
+bool Contract::isComplete() const
 {
-    cooldownSeconds = json.at(U("cooldown")).at(U("remainingSeconds")).as_integer();
+    for (auto &good : deliver)
+    {
+        if (good.unitsFulfilled < good.unitsRequired)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+DeliverResponse::DeliverResponse(const json::value &json) : contract(json.at(U("contract"))), cargo(json.at(U("cargo")))
+{
+    contractId = contract.id;
+}
+
+NavResponse::NavResponse(const json::value &json) : nav(json.at(U("nav"))), fuel(json.at(U("fuel")))
+{
+}
+
+TradeGood::TradeGood(const json::value &json)
+{
+    symbol = json.at(U("symbol")).as_string();
+    tradeVolume = json.at(U("tradeVolume")).as_integer();
+    supply = json.at(U("supply")).as_string();
+    purchasePrice = json.at(U("purchasePrice")).as_integer();
+    sellPrice = json.at(U("sellPrice")).as_integer();
+}
+
+Waypoint::Waypoint(const json::value &json)
+{
+    symbol = json.at(U("symbol")).as_string();
+    type = json.at(U("type")).as_string();
+    systemSymbol = json.at(U("systemSymbol")).as_string();
+    x = json.at(U("x")).as_integer();
+    y = json.at(U("y")).as_integer();
+    if (json.has_field(U("traits")))
+    {
+        for (const auto &trait : json.at(U("traits")).as_array())
+        {
+            traits.push_back(trait.at(U("symbol")).as_string());
+        }
+    }
 }
 
-SellResponse::SellResponse(web::json::value json) : cargo(json.at(U("cargo")))
+bool Waypoint::hasTrait(const std::string &trait) const
 {
-    tradeSymbol = json.at(U("transaction")).at(U("tradeSymbol")).as_string();
-    units = json.at(U("transaction")).at(U("units")).as_integer();
-    totalPrice = json.at(U("transaction")).at(U("totalPrice")).as_integer();
-    pricePerUnit = json.at(U("transaction")).at(U("pricePerUnit")).as_integer();
+    return std::find(traits.begin(), traits.end(), trait) != traits.end();
 }
 
-NavResponse::NavResponse(json::value json) : nav(json.at(U("nav"))), fuel(json.at(U("fuel")))
+Market::Market(const json::value &json)
 {
-}
\ No newline at end of file
+    symbol = json.at(U("symbol")).as_string();
+    for (auto field : {U("imports"), U("exports"), U("exchange")})
+    {
+        if (!json.has_field(field))
+        {
+            continue;
+        }
+        for (const auto &good : json.at(field).as_array())
+        {
+            tradeSymbols.push_back(good.at(U("symbol")).as_string());
+        }
+    }
+    if (!json.has_field(U("tradeGoods")))
+    {
+        return;
+    }
+    const json::array &items = json.at(U("tradeGoods")).as_array();
+    tradeGoods.reserve(items.size());
+    for (const auto &item : items)
+    {
+        tradeGoods.push_back(TradeGood(item));
+    }
+}
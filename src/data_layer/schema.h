@@ -7,7 +7,7 @@ namespace schema
     class CargoItem
     {
     public:
-        CargoItem(web::json::value json);
+        CargoItem(const web::json::value &json);
 
         std::string symbol;
         std::string name;
@@ -18,7 +18,9 @@ namespace schema
     class Cargo
     {
     public:
-        Cargo(web::json::value json);
+        // pplx::task keeps a default constructed result until the real one arrives
+        Cargo() = default;
+        Cargo(const web::json::value &json);
 
         bool isFull();
         bool isEmpty();
@@ -31,7 +33,8 @@ namespace schema
     class Fuel
     {
     public:
-        Fuel(web::json::value json);
+        Fuel() = default;
+        Fuel(const web::json::value &json);
 
         int current;
         int capacity;
@@ -43,26 +46,18 @@ namespace schema
     class ShipBasic
     {
     public:
-        ShipBasic(web::json::value json);
+        ShipBasic(const web::json::value &json);
 
         std::string symbol;
         std::string name;
         std::string role;
     };
 
-    class Ship : public ShipBasic
-    {
-    public:
-        Ship(web::json::value json);
-
-        Cargo cargo;
-        Fuel fuel;
-    };
-
     class Yield
     {
     public:
-        Yield(web::json::value json);
+        Yield() = default;
+        Yield(const web::json::value &json);
 
         std::string symbol;
         int units;
@@ -72,7 +67,8 @@ namespace schema
     class NavRouteWaypoint
     {
     public:
-        NavRouteWaypoint(web::json::value json);
+        NavRouteWaypoint() = default;
+        NavRouteWaypoint(const web::json::value &json);
 
         std::string symbol;
         std::string type;
@@ -84,8 +80,8 @@ namespace schema
     class NavRoute
     {
     public:
-        NavRoute(web::json::value json);
-        int getETA();
+        NavRoute() = default;
+        NavRoute(const web::json::value &json);
 
         NavRouteWaypoint departure;
         NavRouteWaypoint destination;
@@ -96,7 +92,8 @@ namespace schema
     class Nav
     {
     public:
-        Nav(web::json::value json);
+        Nav() = default;
+        Nav(const web::json::value &json);
 
         std::string systemSymbol;
         std::string waypointSymbol;
@@ -105,21 +102,47 @@ namespace schema
         std::string flightMode;
     };
 
+    class Mount
+    {
+    public:
+        Mount(const web::json::value &json);
+
+        std::string symbol;
+        std::string name;
+        // zero for mounts that do not report one
+        int strength;
+    };
+
+    class Ship : public ShipBasic
+    {
+    public:
+        Ship(const web::json::value &json);
+
+        Cargo cargo;
+        Fuel fuel;
+        Nav nav;
+        std::vector<Mount> mounts;
+    };
+
     class ExtractResponse
     {
     public:
-        ExtractResponse(web::json::value json);
+        ExtractResponse() = default;
+        ExtractResponse(const web::json::value &json);
 
         Yield yield;
         int cooldownSeconds;
+        std::string cooldownExpiration;
         Cargo cargo;
     };
 
     class SellResponse
     {
     public:
-        SellResponse(web::json::value json);
+        SellResponse() = default;
+        SellResponse(const web::json::value &json);
 
+        std::string waypointSymbol;
         std::string tradeSymbol;
         int units;
         int totalPrice;
@@ -127,10 +150,91 @@ namespace schema
         Cargo cargo;
     };
 
+    class ContractDeliverGood
+    {
+    public:
+        ContractDeliverGood(const web::json::value &json);
+
+        std::string tradeSymbol;
+        std::string destinationSymbol;
+        int unitsRequired;
+        int unitsFulfilled;
+    };
+
+    class Contract
+    {
+    public:
+        Contract() = default;
+        Contract(const web::json::value &json);
+        // units of the good still to be delivered, zero if the contract does not ask for it
+        int getRemaining(const std::string &tradeSymbol) const;
+        bool isComplete() const;
+
+        std::string id;
+        std::string type;
+        std::string deadline;
+        std::vector<ContractDeliverGood> deliver;
+        bool accepted = false;
+        bool fulfilled = false;
+    };
+
+    class DeliverResponse
+    {
+    public:
+        DeliverResponse() = default;
+        DeliverResponse(const web::json::value &json);
+
+        std::string contractId;
+        Contract contract;
+        Cargo cargo;
+    };
+
+    class TradeGood
+    {
+    public:
+        TradeGood(const web::json::value &json);
+
+        std::string symbol;
+        int tradeVolume;
+        std::string supply;
+        // what the market charges, and what it pays for a unit sold to it
+        int purchasePrice;
+        int sellPrice;
+    };
+
+    class Waypoint
+    {
+    public:
+        Waypoint() = default;
+        Waypoint(const web::json::value &json);
+        bool hasTrait(const std::string &trait) const;
+
+        std::string symbol;
+        std::string type;
+        std::string systemSymbol;
+        int x;
+        int y;
+        std::vector<std::string> traits;
+    };
+
+    class Market
+    {
+    public:
+        Market() = default;
+        Market(const web::json::value &json);
+
+        std::string symbol;
+        // every good listed under imports, exports and exchange, known without a ship present
+        std::vector<std::string> tradeSymbols;
+        // only listed while one of our ships is at the waypoint
+        std::vector<TradeGood> tradeGoods;
+    };
+
     class NavResponse
     {
     public:
-        NavResponse(web::json::value json);
+        NavResponse() = default;
+        NavResponse(const web::json::value &json);
 
         Fuel fuel;
         Nav nav;
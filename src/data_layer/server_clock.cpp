@@ -0,0 +1,140 @@
+#include "spdlog/spdlog.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+#include "server_clock.h"
+
+using namespace dal;
+
+namespace
+{
+    // days since 1970-01-01 of a proleptic Gregorian date, without going through time_t and the local zone
+    long long daysFromCivil(int year, unsigned month, unsigned day)
+    {
+        year -= month <= 2;
+        const int era = (year >= 0 ? year : year - 399) / 400;
+        const unsigned yearOfEra = (unsigned)(year - era * 400);
+        const unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return (long long)era * 146097 + (long long)dayOfEra - 719468;
+    }
+
+    std::chrono::system_clock::time_point fromCivil(int year, int month, int day, int hour, int minute, int second, int millisecond)
+    {
+        long long seconds = daysFromCivil(year, month, day) * 86400LL + hour * 3600LL + minute * 60LL + second;
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::seconds(seconds) + std::chrono::milliseconds(millisecond)));
+    }
+}
+
+ServerClock::ServerClock() : calibrated(false), lowerBound(0), upperBound(0)
+{
+}
+
+std::chrono::system_clock::time_point ServerClock::parseTimestamp(const std::string &timestamp)
+{
+    int year, month, day, hour, minute, second, consumed = 0;
+    if (std::sscanf(timestamp.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d%n", &year, &month, &day, &hour, &minute, &second, &consumed) != 6)
+    {
+        throw std::invalid_argument("Invalid timestamp " + timestamp);
+    }
+
+    const char *p_rest = timestamp.c_str() + consumed;
+    int millisecond = 0;
+    if (*p_rest == '.')
+    {
+        // keep the first three digits, anything finer is below what the scheduler can use
+        int digits = 0;
+        for (p_rest++; *p_rest >= '0' && *p_rest <= '9'; p_rest++, digits++)
+        {
+            if (digits < 3)
+            {
+                millisecond = millisecond * 10 + (*p_rest - '0');
+            }
+        }
+        for (; digits < 3; digits++)
+        {
+            millisecond *= 10;
+        }
+    }
+
+    std::chrono::system_clock::time_point time = fromCivil(year, month, day, hour, minute, second, millisecond);
+    int offsetHours, offsetMinutes;
+    if ((*p_rest == '+' || *p_rest == '-') && std::sscanf(p_rest + 1, "%2d:%2d", &offsetHours, &offsetMinutes) == 2)
+    {
+        std::chrono::minutes offset(offsetHours * 60 + offsetMinutes);
+        time += *p_rest == '+' ? -offset : offset;
+    }
+    return time;
+}
+
+std::chrono::system_clock::time_point ServerClock::parseHttpDate(const std::string &date)
+{
+    static const char *MONTHS = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    char weekday[4], monthName[4];
+    int day, year, hour, minute, second;
+    if (std::sscanf(date.c_str(), "%3s, %2d %3s %4d %2d:%2d:%2d", weekday, &day, monthName, &year, &hour, &minute, &second) != 7)
+    {
+        throw std::invalid_argument("Invalid HTTP date " + date);
+    }
+    const char *p_month = std::strstr(MONTHS, monthName);
+    if (p_month == nullptr || (p_month - MONTHS) % 3 != 0)
+    {
+        throw std::invalid_argument("Invalid HTTP date " + date);
+    }
+    return fromCivil(year, (int)(p_month - MONTHS) / 3 + 1, day, hour, minute, second, 0);
+}
+
+std::string ServerClock::formatTimestamp(std::chrono::system_clock::time_point time)
+{
+    std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+    int milliseconds = (int)(std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count() % 1000);
+    std::tm tm = {};
+    gmtime_r(&seconds, &tm);
+    char timestamp[32];
+    std::snprintf(timestamp, sizeof(timestamp), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                  tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, milliseconds);
+    return timestamp;
+}
+
+void ServerClock::observe(std::chrono::system_clock::time_point serverTime,
+                          std::chrono::milliseconds resolution,
+                          std::chrono::system_clock::time_point sent,
+                          std::chrono::system_clock::time_point received)
+{
+    // serverTime is truncated, the real reading lies in [serverTime, serverTime + resolution)
+    auto lower = std::chrono::duration_cast<std::chrono::milliseconds>(serverTime - received);
+    auto upper = std::chrono::duration_cast<std::chrono::milliseconds>(serverTime + resolution - sent);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!calibrated || lower > upperBound || upper < lowerBound)
+    {
+        if (calibrated)
+        {
+            spdlog::warn("ServerClock: Sample [{}, {}] ms contradicts [{}, {}] ms, recalibrating.",
+                         lower.count(), upper.count(), lowerBound.count(), upperBound.count());
+        }
+        calibrated = true;
+        lowerBound = lower;
+        upperBound = upper;
+        return;
+    }
+    lowerBound = std::max(lowerBound, lower);
+    upperBound = std::min(upperBound, upper);
+}
+
+std::chrono::milliseconds ServerClock::getOffset() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return (lowerBound + upperBound) / 2;
+}
+
+std::chrono::steady_clock::time_point ServerClock::toSteady(std::chrono::system_clock::time_point serverTime) const
+{
+    auto localTime = serverTime - getOffset();
+    return std::chrono::steady_clock::now() +
+           std::chrono::duration_cast<std::chrono::steady_clock::duration>(localTime - std::chrono::system_clock::now());
+}
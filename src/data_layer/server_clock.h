@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+namespace dal
+{
+    class ServerClock
+    {
+    public:
+        ServerClock();
+
+        // ISO-8601 as the API sends it, e.g. 2023-05-27T08:12:54.412Z, with millisecond precision
+        static std::chrono::system_clock::time_point parseTimestamp(const std::string &timestamp);
+        // RFC 1123 as in the Date header, e.g. Sat, 27 May 2023 08:12:54 GMT
+        static std::chrono::system_clock::time_point parseHttpDate(const std::string &date);
+        // the inverse of parseTimestamp
+        static std::string formatTimestamp(std::chrono::system_clock::time_point time);
+
+        void observe(std::chrono::system_clock::time_point serverTime,
+                     std::chrono::milliseconds resolution,
+                     std::chrono::system_clock::time_point sent,
+                     std::chrono::system_clock::time_point received);
+        std::chrono::milliseconds getOffset() const;
+        std::chrono::steady_clock::time_point toSteady(std::chrono::system_clock::time_point serverTime) const;
+
+    private:
+        /* The server read its clock somewhere between sending and receiving, so every response
+        bounds server minus local time from both sides. The bounds of all samples are intersected
+        and the middle of what is left is the offset, a sample that contradicts them (the local clock
+        was stepped) starts over.
+        */
+        mutable std::mutex mutex;
+        bool calibrated;
+        std::chrono::milliseconds lowerBound;
+        std::chrono::milliseconds upperBound;
+    };
+};
@@ -0,0 +1,198 @@
+#include "spdlog/spdlog.h"
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "traffic_log.h"
+#include "server_clock.h"
+
+using namespace dal;
+using namespace web;
+
+namespace
+{
+    // durations the automation waits on, they shrink with the time scale like the timestamps do
+    const char *DURATION_FIELDS[] = {"remainingSeconds", "totalSeconds", "secondsToArrival", "retryAfter"};
+
+    bool isDurationField(const std::string &key)
+    {
+        for (const char *field : DURATION_FIELDS)
+        {
+            if (key == field)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 2023-05-27T08:12:54.412Z, checked cheaply before it is parsed
+    bool looksLikeTimestamp(const std::string &value)
+    {
+        return value.size() >= 20 && value.size() <= 30 && value[4] == '-' && value[10] == 'T' && value.back() == 'Z';
+    }
+}
+
+TrafficRecorder::TrafficRecorder(const std::string &path, int flushEvery)
+    : file(path, std::ios::out | std::ios::app), startedAt(std::chrono::steady_clock::now()), flushEvery(flushEvery), unflushed(0)
+{
+    if (!file)
+    {
+        throw std::runtime_error("Cannot open traffic log " + path);
+    }
+}
+
+TrafficRecorder::~TrafficRecorder()
+{
+    file.flush();
+}
+
+void TrafficRecorder::record(const TrafficEntry &entry, std::chrono::steady_clock::time_point sentAt)
+{
+    // serialized before the lock is taken, only the write is serial
+    json::value line = json::value::object();
+    line[U("t")] = json::value::number((int64_t)std::chrono::duration_cast<std::chrono::milliseconds>(sentAt - startedAt).count());
+    line[U("m")] = json::value::string(entry.method);
+    line[U("p")] = json::value::string(entry.path);
+    if (!entry.body.empty())
+    {
+        line[U("b")] = json::value::string(entry.body);
+    }
+    line[U("s")] = json::value::number(entry.statusCode);
+    line[U("l")] = json::value::number((int64_t)entry.latency.count());
+    line[U("w")] = json::value::number((int64_t)std::chrono::duration_cast<std::chrono::milliseconds>(entry.serverTime.time_since_epoch()).count());
+    line[U("r")] = entry.response;
+    std::string text = line.serialize();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    file << text << '\n';
+    if (++unflushed >= flushEvery)
+    {
+        file.flush();
+        unflushed = 0;
+    }
+}
+
+TrafficReplayer::TrafficReplayer(const std::string &path, double timeScale)
+    : timeScale(timeScale > 0 ? timeScale : 1.0), remaining(0)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        throw std::runtime_error("Cannot open traffic log " + path);
+    }
+
+    std::string text;
+    while (std::getline(file, text))
+    {
+        json::value line;
+        try
+        {
+            line = json::value::parse(text);
+        }
+        catch (const json::json_exception &e)
+        {
+            // the last line of a trace that was cut short
+            spdlog::warn("TrafficReplayer: Skipping a damaged line of {}: {}", path, e.what());
+            continue;
+        }
+        TrafficEntry entry;
+        entry.sentAt = std::chrono::milliseconds(line.at(U("t")).as_number_i64());
+        entry.method = line.at(U("m")).as_string();
+        entry.path = line.at(U("p")).as_string();
+        entry.body = line.has_field(U("b")) ? line.at(U("b")).as_string() : "";
+        entry.statusCode = line.at(U("s")).as_integer();
+        entry.latency = std::chrono::microseconds(line.at(U("l")).as_number_i64());
+        entry.serverTime = std::chrono::system_clock::time_point(std::chrono::milliseconds(line.at(U("w")).as_number_i64()));
+        entry.response = line.at(U("r"));
+        entries[key(entry.method, entry.path, entry.body)].push_back(entry);
+        remaining++;
+    }
+    // the file is in the order responses arrived, a queue is served in the order requests went out
+    for (auto &queue : entries)
+    {
+        std::stable_sort(queue.second.begin(), queue.second.end(), [](const TrafficEntry &a, const TrafficEntry &b)
+                         { return a.sentAt < b.sentAt; });
+    }
+}
+
+bool TrafficReplayer::next(const std::string &method, const std::string &path, const std::string &body, TrafficEntry &entry)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto queue = entries.find(key(method, path, body));
+    if (queue == entries.end() || queue->second.empty())
+    {
+        return false;
+    }
+    entry = queue->second.front();
+    queue->second.pop_front();
+    remaining--;
+    return true;
+}
+
+std::string TrafficReplayer::key(const std::string &method, const std::string &path, const std::string &body)
+{
+    return method + " " + path + " " + body;
+}
+
+json::value TrafficReplayer::retime(const TrafficEntry &entry) const
+{
+    json::value response = entry.response;
+    retimeValue(response, "", entry.serverTime, std::chrono::system_clock::now());
+    return response;
+}
+
+std::chrono::microseconds TrafficReplayer::getLatency(const TrafficEntry &entry) const
+{
+    return std::chrono::microseconds((long long)(entry.latency.count() / timeScale));
+}
+
+std::size_t TrafficReplayer::getRemaining() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return remaining;
+}
+
+void TrafficReplayer::retimeValue(json::value &value, const std::string &key, std::chrono::system_clock::time_point serverTime, std::chrono::system_clock::time_point now) const
+{
+    if (value.is_object())
+    {
+        for (auto &field : value.as_object())
+        {
+            retimeValue(field.second, field.first, serverTime, now);
+        }
+    }
+    else if (value.is_array())
+    {
+        for (auto &item : value.as_array())
+        {
+            retimeValue(item, key, serverTime, now);
+        }
+    }
+    else if (value.is_string() && looksLikeTimestamp(value.as_string()))
+    {
+        try
+        {
+            auto ahead = ServerClock::parseTimestamp(value.as_string()) - serverTime;
+            auto scaled = std::chrono::duration_cast<std::chrono::system_clock::duration>(ahead / timeScale);
+            value = json::value::string(ServerClock::formatTimestamp(now + scaled));
+        }
+        catch (const std::invalid_argument &)
+        {
+            // a symbol or message that only looked like one
+        }
+    }
+    else if (value.is_number() && isDurationField(key))
+    {
+        if (value.is_integer())
+        {
+            value = json::value::number((int)std::lround(value.as_integer() / timeScale));
+        }
+        else
+        {
+            value = json::value::number(value.as_double() / timeScale);
+        }
+    }
+}
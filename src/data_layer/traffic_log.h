@@ -0,0 +1,83 @@
+#pragma once
+
+#include "spdlog/spdlog.h"
+#include <cpprest/json.h>
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace dal
+{
+    // one round trip as the DAL saw it
+    struct TrafficEntry
+    {
+        // since the recording started
+        std::chrono::milliseconds sentAt;
+        std::string method;
+        // with the query
+        std::string path;
+        std::string body;
+        int statusCode;
+        std::chrono::microseconds latency;
+        // server time when the response arrived, what the timestamps in it are relative to
+        std::chrono::system_clock::time_point serverTime;
+        web::json::value response;
+    };
+
+    /* Appends every round trip to a JSON lines file with short keys, one line per request:
+    {"t":sentAt ms,"m":method,"p":path,"b":body,"s":status,"l":latency us,"w":server ms,"r":response}
+    Lines are written as they come and flushed every flushEvery lines, a trace of a crashed run
+    only loses its tail. Thread safe.
+    */
+    class TrafficRecorder
+    {
+    public:
+        // throws std::runtime_error if the file cannot be opened
+        TrafficRecorder(const std::string &path, int flushEvery = 64);
+        ~TrafficRecorder();
+
+        void record(const TrafficEntry &entry, std::chrono::steady_clock::time_point sentAt);
+
+    private:
+        std::ofstream file;
+        std::chrono::steady_clock::time_point startedAt;
+        int flushEvery;
+        int unflushed;
+        std::mutex mutex;
+    };
+
+    /* Serves the responses of a recording in place of the server. Each method, path and body has its
+    own queue, ordered by when the requests were sent, so every ship gets its answers in the order it
+    asked for them, however the requests of the fleet interleave, and the concurrent sells of one
+    batch do not trade answers. Time runs timeScale times faster than it did: the latency is
+    shortened, and every timestamp and duration in a response is moved so that it lies as far ahead
+    of now as it lay ahead of the server's clock, divided by timeScale. Thread safe.
+    */
+    class TrafficReplayer
+    {
+    public:
+        // throws std::runtime_error if the file cannot be read
+        TrafficReplayer(const std::string &path, double timeScale = 1.0);
+
+        // false once the recording has nothing left for this request
+        bool next(const std::string &method, const std::string &path, const std::string &body, TrafficEntry &entry);
+        // the response as if the server sent it now, call it once the latency has passed
+        web::json::value retime(const TrafficEntry &entry) const;
+        std::chrono::microseconds getLatency(const TrafficEntry &entry) const;
+        std::size_t getRemaining() const;
+
+    private:
+        static std::string key(const std::string &method, const std::string &path, const std::string &body);
+        void retimeValue(web::json::value &value, const std::string &key, std::chrono::system_clock::time_point serverTime, std::chrono::system_clock::time_point now) const;
+
+        double timeScale;
+        std::unordered_map<std::string, std::deque<TrafficEntry>> entries;
+        std::size_t remaining;
+        mutable std::mutex mutex;
+    };
+}
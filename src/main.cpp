@@ -1,14 +1,24 @@
 // https://github.com/Microsoft/cpprestsdk/wiki/Getting-Started-Tutorial
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <string>
 #include <iostream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <system_error>
 #include <thread>
 #include <vector>
 
 #include "data_layer/schema.h"
 #include "data_layer/data_access.h"
+#include "data_layer/logging.h"
 #include "automation/ship_auto.h"
+#include "automation/scheduler.h"
+#include "automation/fleet.h"
+#include "metrics/exporter.h"
 
 using namespace schema;
 using namespace web;
@@ -28,19 +38,84 @@ void printShip(std::vector<Ship> ships)
 
 int main()
 {   
-    spdlog::set_level(spdlog::level::debug);
-    // spdlog::set_default_logger(some_other_logger);
+    // LOG_LEVEL=info in production skips formatting every debug message, LOG_ASYNC=1 moves writing off the ship threads
+    const char *logLevel = std::getenv("LOG_LEVEL");
+    const char *logAsync = std::getenv("LOG_ASYNC");
+    logging::init(
+        logLevel != nullptr ? spdlog::level::from_str(logLevel) : spdlog::level::debug,
+        logAsync != nullptr && std::string(logAsync) == "1");
 
     spdlog::info("***** started *****");
 
-    const std::string baseURI = "https://api.spacetraders.io/v2/";
-    dal::DataAccessLayer DALInstance(baseURI);
+    // METRICS_PORT serves /metrics for Prometheus, METRICS_INTERVAL logs a summary every so many seconds
+    const char *metricsPort = std::getenv("METRICS_PORT");
+    const char *metricsInterval = std::getenv("METRICS_INTERVAL");
+    std::unique_ptr<metrics::MetricsServer> metricsServer;
+    std::unique_ptr<metrics::Reporter> metricsReporter;
+    if (metricsPort != nullptr)
+    {
+        metricsServer.reset(new metrics::MetricsServer(std::string("http://0.0.0.0:") + metricsPort));
+        metricsServer->open();
+    }
+    if (metricsInterval != nullptr)
+    {
+        metricsReporter.reset(new metrics::Reporter(std::chrono::seconds(std::atoi(metricsInterval))));
+        metricsReporter->start();
+    }
+
+    // BASE_URI points the fleet at a local space-traders-mock instead of the live API
+    const char *baseURIEnv = std::getenv("BASE_URI");
+    const std::string baseURI = baseURIEnv != nullptr ? baseURIEnv : "https://api.spacetraders.io/v2/";
+    // TRAFFIC_RECORD appends every round trip to a trace, TRAFFIC_REPLAY answers from one instead of the server
+    const char *trafficRecordEnv = std::getenv("TRAFFIC_RECORD");
+    const char *trafficReplayEnv = std::getenv("TRAFFIC_REPLAY");
+    const char *trafficTimeScaleEnv = std::getenv("TRAFFIC_TIME_SCALE");
+    dal::DataAccessConfig dalConfig;
+    if (trafficRecordEnv != nullptr)
+    {
+        dalConfig.trafficRecorder = std::make_shared<dal::TrafficRecorder>(trafficRecordEnv);
+    }
+    if (trafficReplayEnv != nullptr)
+    {
+        double timeScale = trafficTimeScaleEnv != nullptr ? std::atof(trafficTimeScaleEnv) : 1.0;
+        dalConfig.trafficReplayer = std::make_shared<dal::TrafficReplayer>(trafficReplayEnv, timeScale);
+        // the trace was throttled by the live rate limit, which runs faster along with the trace
+        dalConfig.requestsPerSecond *= timeScale;
+        dalConfig.burst = std::max(dalConfig.burst, (int)dalConfig.requestsPerSecond);
+    }
+    dal::DataAccessLayer DALInstance(baseURI, dalConfig);
 
     spdlog::info("***** getting ship *****");
 
     std::vector<Ship> ships = DALInstance.getShips();
     printShip(ships);
 
+    // ASTEROID_FIELDS is a comma separated list of the fields the planner may send ships to
+    const char *asteroidFieldsEnv = std::getenv("ASTEROID_FIELDS");
+    std::stringstream fieldStream(asteroidFieldsEnv != nullptr ? asteroidFieldsEnv : "X1-VS75-67965Z");
+    std::vector<std::string> asteroidFields;
+    std::string field;
+    while (std::getline(fieldStream, field, ','))
+    {
+        asteroidFields.push_back(field);
+    }
+    automation::Fleet fleet(asteroidFields);
+    // STATE_DIR keeps what every ship was doing across restarts
+    const char *stateDir = std::getenv("STATE_DIR");
+    if (stateDir != nullptr)
+    {
+        fleet.journal.reset(new automation::ShipJournal(stateDir));
+    }
+    std::set<std::string> systems;
+    for (auto &ship : ships)
+    {
+        systems.insert(ship.nav.systemSymbol);
+    }
+    for (auto &system : systems)
+    {
+        fleet.load(DALInstance, system);
+    }
+
     std::vector<automation::ship::ShipAutomator> shipAutomators;
     for (auto &ship : ships)
     {
@@ -48,24 +123,45 @@ int main()
         //     continue;
         // }
 
-        shipAutomators.emplace_back(ship, DALInstance);
+        shipAutomators.emplace_back(ship, DALInstance, fleet);
         spdlog::info("Creating ship automator for {}", ship.symbol);
     }
 
-    std::vector<std::thread> automationThreads;
+    // ships spend most of their time waiting on cooldowns, so a few workers serve the whole fleet
+    const int workerCount = 4;
+    automation::Scheduler scheduler(workerCount);
     for (auto &shipAutomator : shipAutomators)
     {
-        spdlog::info("Starting thread for {}", shipAutomator.getShipSymbol());
-        automationThreads.emplace_back(&automation::ship::ShipAutomator::start, &shipAutomator);
+        spdlog::info("Scheduling {}", shipAutomator.getShipSymbol());
+        scheduler.add(shipAutomator);
+    }
+    // the ships were just listed, the first refresh waits a full interval
+    scheduler.add([&fleet, &DALInstance, &scheduler]()
+                  {
+                      spdlog::info("Fleet: {}", scheduler.describeFleet());
+                      return fleet.ships.refresh(DALInstance); },
+                  fleet.ships.getRefreshInterval());
+    // checkpoints fsync, so they run as a job of their own rather than inside a ship's step
+    if (fleet.journal != nullptr)
+    {
+        scheduler.add([&fleet]()
+                      {
+                          try
+                          {
+                              fleet.journal->checkpoint();
+                          }
+                          catch (const std::system_error &e)
+                          {
+                              spdlog::warn("Could not checkpoint the ship journal: {}", e.what());
+                          }
+                          return std::chrono::milliseconds(fleet.journal->getCheckpointInterval()); },
+                      fleet.journal->getCheckpointInterval());
     }
 
     // automation::ship::ShipAutomator shipAutomator(ships[2], DALInstance);
     // shipAutomator.start();
 
-    for (auto &automationThread : automationThreads)
-    {
-        automationThread.join();
-    }
+    scheduler.run();
 
     spdlog::info("***** ended *****");
     return 0;
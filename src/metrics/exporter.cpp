@@ -0,0 +1,168 @@
+#include "spdlog/spdlog.h"
+#include <fmt/core.h>
+#include <fmt/format.h>
+
+#include <iterator>
+
+#include "exporter.h"
+
+using namespace metrics;
+using namespace web;
+using namespace web::http;
+using namespace web::http::experimental::listener;
+
+// bucket bounds exported to Prometheus, in microseconds
+const uint64_t EXPORTED_BOUNDS[] = {1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000};
+
+std::string stateName(const Snapshot &snapshot, int state)
+{
+    return state < (int)snapshot.stateNames.size() ? snapshot.stateNames[state] : std::to_string(state);
+}
+
+std::string metrics::renderPrometheus(const Snapshot &snapshot)
+{
+    fmt::memory_buffer out;
+    auto it = std::back_inserter(out);
+
+    fmt::format_to(it, "# TYPE space_traders_requests_total counter\n");
+    for (int e = 0; e < ENDPOINTS; e++)
+    {
+        fmt::format_to(it, "space_traders_requests_total{{endpoint=\"{}\"}} {}\n", endpointName((Endpoint)e), snapshot.calls[e]);
+    }
+    fmt::format_to(it, "# TYPE space_traders_request_errors_total counter\n");
+    for (int e = 0; e < ENDPOINTS; e++)
+    {
+        fmt::format_to(it, "space_traders_request_errors_total{{endpoint=\"{}\"}} {}\n", endpointName((Endpoint)e), snapshot.errors[e]);
+    }
+    fmt::format_to(it, "# TYPE space_traders_rate_limited_total counter\n");
+    for (int e = 0; e < ENDPOINTS; e++)
+    {
+        fmt::format_to(it, "space_traders_rate_limited_total{{endpoint=\"{}\"}} {}\n", endpointName((Endpoint)e), snapshot.rateLimited[e]);
+    }
+    fmt::format_to(it, "# TYPE space_traders_retries_total counter\n");
+    for (int e = 0; e < ENDPOINTS; e++)
+    {
+        fmt::format_to(it, "space_traders_retries_total{{endpoint=\"{}\"}} {}\n", endpointName((Endpoint)e), snapshot.retries[e]);
+    }
+
+    fmt::format_to(it, "# TYPE space_traders_request_latency_seconds histogram\n");
+    for (int e = 0; e < ENDPOINTS; e++)
+    {
+        const char *name = endpointName((Endpoint)e);
+        uint64_t cumulative = 0;
+        int bucket = 0;
+        for (uint64_t bound : EXPORTED_BOUNDS)
+        {
+            while (bucket < Histogram::BUCKETS && Histogram::upperBound(bucket) <= bound)
+            {
+                cumulative += snapshot.latencyCounts[e][bucket++];
+            }
+            fmt::format_to(it, "space_traders_request_latency_seconds_bucket{{endpoint=\"{}\",le=\"{}\"}} {}\n", name, bound / 1e6, cumulative);
+        }
+        fmt::format_to(it, "space_traders_request_latency_seconds_bucket{{endpoint=\"{}\",le=\"+Inf\"}} {}\n", name, snapshot.calls[e]);
+        fmt::format_to(it, "space_traders_request_latency_seconds_sum{{endpoint=\"{}\"}} {}\n", name, snapshot.latencySum[e] / 1e6);
+        fmt::format_to(it, "space_traders_request_latency_seconds_count{{endpoint=\"{}\"}} {}\n", name, snapshot.calls[e]);
+    }
+
+    fmt::format_to(it, "# TYPE space_traders_state_dwell_seconds summary\n");
+    for (int s = 0; s < MAX_STATES; s++)
+    {
+        if (snapshot.stateEntries[s] == 0)
+        {
+            continue;
+        }
+        std::string name = stateName(snapshot, s);
+        fmt::format_to(it, "space_traders_state_dwell_seconds_sum{{state=\"{}\"}} {}\n", name, snapshot.stateDwell[s] / 1e6);
+        fmt::format_to(it, "space_traders_state_dwell_seconds_count{{state=\"{}\"}} {}\n", name, snapshot.stateEntries[s]);
+    }
+    return fmt::to_string(out);
+}
+
+std::string metrics::renderSummary(const Snapshot &snapshot)
+{
+    fmt::memory_buffer out;
+    auto it = std::back_inserter(out);
+
+    for (int e = 0; e < ENDPOINTS; e++)
+    {
+        if (snapshot.calls[e] == 0)
+        {
+            continue;
+        }
+        Endpoint endpoint = (Endpoint)e;
+        fmt::format_to(it, "\n  {:<17} calls={} errors={} 429={} retries={} p50={:.1f}ms p99={:.1f}ms",
+                       endpointName(endpoint), snapshot.calls[e], snapshot.errors[e], snapshot.rateLimited[e], snapshot.retries[e],
+                       snapshot.quantile(endpoint, 0.50) / 1000.0, snapshot.quantile(endpoint, 0.99) / 1000.0);
+    }
+    for (int s = 0; s < MAX_STATES; s++)
+    {
+        if (snapshot.stateEntries[s] == 0)
+        {
+            continue;
+        }
+        fmt::format_to(it, "\n  {:<17} entries={} mean dwell={:.2f}s",
+                       stateName(snapshot, s), snapshot.stateEntries[s], snapshot.stateDwell[s] / 1e6 / snapshot.stateEntries[s]);
+    }
+    return fmt::to_string(out);
+}
+
+MetricsServer::MetricsServer(const std::string &uri) : listener(U(uri))
+{
+    listener.support(methods::GET, [](http_request request)
+                     {
+                         std::vector<std::string> path = uri::split_path(request.relative_uri().path());
+                         if (path.size() != 1 || path[0] != "metrics")
+                         {
+                             request.reply(status_codes::NotFound);
+                             return;
+                         }
+                         request.reply(status_codes::OK, renderPrometheus(*registry().snapshot()), "text/plain; version=0.0.4"); });
+}
+
+void MetricsServer::open()
+{
+    listener.open().wait();
+}
+
+void MetricsServer::close()
+{
+    listener.close().wait();
+}
+
+Reporter::Reporter(std::chrono::seconds interval) : interval(interval), running(false)
+{
+}
+
+Reporter::~Reporter()
+{
+    stop();
+}
+
+void Reporter::start()
+{
+    running = true;
+    thread = std::thread(&Reporter::loop, this);
+}
+
+void Reporter::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    stopped.notify_all();
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+}
+
+void Reporter::loop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopped.wait_for(lock, interval, [this]
+                             { return !running; }))
+    {
+        spdlog::info("Metrics:{}", renderSummary(*registry().snapshot()));
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "spdlog/spdlog.h"
+#include <cpprest/http_listener.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "metrics.h"
+
+namespace metrics
+{
+    // Prometheus text exposition format, latency buckets are folded onto a fixed set of bounds
+    std::string renderPrometheus(const Snapshot &snapshot);
+    // one line per endpoint and state, for the log
+    std::string renderSummary(const Snapshot &snapshot);
+
+    class MetricsServer
+    {
+    public:
+        // serves GET {uri}/metrics
+        MetricsServer(const std::string &uri);
+        void open();
+        void close();
+
+    private:
+        web::http::experimental::listener::http_listener listener;
+    };
+
+    class Reporter
+    {
+    public:
+        // logs renderSummary every interval from its own thread
+        Reporter(std::chrono::seconds interval);
+        ~Reporter();
+        void start();
+        void stop();
+
+    private:
+        void loop();
+
+        std::chrono::seconds interval;
+        bool running;
+        std::mutex mutex;
+        std::condition_variable stopped;
+        std::thread thread;
+    };
+}
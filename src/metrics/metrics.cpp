@@ -0,0 +1,193 @@
+#include "spdlog/spdlog.h"
+
+#include "metrics.h"
+
+using namespace metrics;
+
+namespace
+{
+    // shards outlive their threads, the pointer is only a shortcut to this thread's one
+    thread_local Shard *p_localShard = nullptr;
+
+    inline void bump(std::atomic<uint64_t> &counter, uint64_t amount = 1)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    inline int highestBit(uint64_t value)
+    {
+        return 63 - __builtin_clzll(value);
+    }
+}
+
+const char *metrics::endpointName(Endpoint endpoint)
+{
+    switch (endpoint)
+    {
+    case GET_SHIPS:
+        return "get_ships";
+    case EXTRACT:
+        return "extract";
+    case GET_CARGO:
+        return "get_cargo";
+    case SELL:
+        return "sell";
+    case NAVIGATE:
+        return "navigate";
+    case DELIVER_CONTRACT:
+        return "deliver_contract";
+    case DOCK:
+        return "dock";
+    case ORBIT:
+        return "orbit";
+    case REFUEL:
+        return "refuel";
+    case GET_MARKET:
+        return "get_market";
+    case GET_CONTRACTS:
+        return "get_contracts";
+    case ACCEPT_CONTRACT:
+        return "accept_contract";
+    case FULFILL_CONTRACT:
+        return "fulfill_contract";
+    case GET_WAYPOINTS:
+        return "get_waypoints";
+    case SET_FLIGHT_MODE:
+        return "set_flight_mode";
+    }
+    return "unknown";
+}
+
+int Histogram::bucketFor(uint64_t value)
+{
+    if (value < SUB_BUCKETS)
+    {
+        return (int)value;
+    }
+    int shift = highestBit(value) - 4;
+    int bucket = SUB_BUCKETS + shift * SUB_BUCKETS + (int)(value >> shift) - SUB_BUCKETS;
+    return bucket < BUCKETS ? bucket : BUCKETS - 1;
+}
+
+uint64_t Histogram::upperBound(int bucket)
+{
+    if (bucket < SUB_BUCKETS)
+    {
+        return (uint64_t)bucket;
+    }
+    int shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+    uint64_t subBucket = (bucket - SUB_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+uint64_t Snapshot::quantile(Endpoint endpoint, double fraction) const
+{
+    uint64_t total = 0;
+    for (int i = 0; i < Histogram::BUCKETS; i++)
+    {
+        total += latencyCounts[endpoint][i];
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)(fraction * total);
+    uint64_t seen = 0;
+    for (int i = 0; i < Histogram::BUCKETS; i++)
+    {
+        seen += latencyCounts[endpoint][i];
+        if (seen > rank)
+        {
+            return Histogram::upperBound(i);
+        }
+    }
+    return Histogram::upperBound(Histogram::BUCKETS - 1);
+}
+
+Shard &Registry::local()
+{
+    if (p_localShard == nullptr)
+    {
+        // value-initialised, so every counter starts at zero
+        std::unique_ptr<Shard> shard(new Shard());
+        p_localShard = shard.get();
+        std::lock_guard<std::mutex> lock(mutex);
+        shards.push_back(std::move(shard));
+    }
+    return *p_localShard;
+}
+
+std::unique_ptr<Snapshot> Registry::snapshot()
+{
+    std::unique_ptr<Snapshot> snapshot(new Snapshot());
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &shard : shards)
+    {
+        for (int e = 0; e < ENDPOINTS; e++)
+        {
+            snapshot->calls[e] += shard->calls[e].load(std::memory_order_relaxed);
+            snapshot->errors[e] += shard->errors[e].load(std::memory_order_relaxed);
+            snapshot->rateLimited[e] += shard->rateLimited[e].load(std::memory_order_relaxed);
+            snapshot->retries[e] += shard->retries[e].load(std::memory_order_relaxed);
+            snapshot->latencySum[e] += shard->latency[e].sum.load(std::memory_order_relaxed);
+            for (int b = 0; b < Histogram::BUCKETS; b++)
+            {
+                snapshot->latencyCounts[e][b] += shard->latency[e].counts[b].load(std::memory_order_relaxed);
+            }
+        }
+        for (int s = 0; s < MAX_STATES; s++)
+        {
+            snapshot->stateEntries[s] += shard->stateEntries[s].load(std::memory_order_relaxed);
+            snapshot->stateDwell[s] += shard->stateDwell[s].load(std::memory_order_relaxed);
+        }
+    }
+    snapshot->stateNames = stateNames;
+    return snapshot;
+}
+
+void Registry::describeStates(const std::vector<std::string> &names)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    stateNames = names;
+}
+
+Registry &metrics::registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+void metrics::recordRequest(Endpoint endpoint, int status, std::chrono::microseconds latency)
+{
+    Shard &shard = registry().local();
+    bump(shard.calls[endpoint]);
+    if (status == 429)
+    {
+        bump(shard.rateLimited[endpoint]);
+    }
+    else if (status >= 400)
+    {
+        bump(shard.errors[endpoint]);
+    }
+
+    uint64_t micros = latency.count() > 0 ? (uint64_t)latency.count() : 0;
+    bump(shard.latency[endpoint].counts[Histogram::bucketFor(micros)]);
+    bump(shard.latency[endpoint].sum, micros);
+}
+
+void metrics::recordRetry(Endpoint endpoint)
+{
+    bump(registry().local().retries[endpoint]);
+}
+
+void metrics::recordStateDwell(int state, std::chrono::microseconds dwell)
+{
+    if (state < 0 || state >= MAX_STATES)
+    {
+        return;
+    }
+    Shard &shard = registry().local();
+    bump(shard.stateEntries[state]);
+    bump(shard.stateDwell[state], (uint64_t)dwell.count());
+}
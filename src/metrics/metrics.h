@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace metrics
+{
+    enum Endpoint
+    {
+        GET_SHIPS,
+        EXTRACT,
+        GET_CARGO,
+        SELL,
+        NAVIGATE,
+        DELIVER_CONTRACT,
+        DOCK,
+        ORBIT,
+        REFUEL,
+        GET_MARKET,
+        GET_CONTRACTS,
+        ACCEPT_CONTRACT,
+        FULFILL_CONTRACT,
+        GET_WAYPOINTS,
+        SET_FLIGHT_MODE,
+    };
+
+    const int ENDPOINTS = 15;
+    const int MAX_STATES = 16;
+
+    const char *endpointName(Endpoint endpoint);
+
+    /* Log-linear latency histogram in microseconds, HDR style: values below 16 are exact and every
+    power of two above is split into 16 sub-buckets, so a recorded value is off by at most 1/16.
+    */
+    struct Histogram
+    {
+        static const int SUB_BUCKETS = 16;
+        static const int BUCKETS = SUB_BUCKETS + 36 * SUB_BUCKETS;
+
+        static int bucketFor(uint64_t value);
+        static uint64_t upperBound(int bucket);
+
+        std::atomic<uint64_t> counts[BUCKETS];
+        std::atomic<uint64_t> sum;
+    };
+
+    /* Counters of a single thread. Only the owning thread writes, so increments are a relaxed load
+    and store without a locked instruction, readers sum every shard.
+    */
+    struct Shard
+    {
+        std::atomic<uint64_t> calls[ENDPOINTS];
+        std::atomic<uint64_t> errors[ENDPOINTS];
+        std::atomic<uint64_t> rateLimited[ENDPOINTS];
+        std::atomic<uint64_t> retries[ENDPOINTS];
+        Histogram latency[ENDPOINTS];
+        std::atomic<uint64_t> stateEntries[MAX_STATES];
+        std::atomic<uint64_t> stateDwell[MAX_STATES];
+    };
+
+    struct Snapshot
+    {
+        uint64_t calls[ENDPOINTS];
+        uint64_t errors[ENDPOINTS];
+        uint64_t rateLimited[ENDPOINTS];
+        uint64_t retries[ENDPOINTS];
+        uint64_t latencyCounts[ENDPOINTS][Histogram::BUCKETS];
+        uint64_t latencySum[ENDPOINTS];
+        uint64_t stateEntries[MAX_STATES];
+        uint64_t stateDwell[MAX_STATES];
+        std::vector<std::string> stateNames;
+
+        // upper bound of the bucket holding the given quantile, in microseconds
+        uint64_t quantile(Endpoint endpoint, double fraction) const;
+    };
+
+    class Registry
+    {
+    public:
+        Shard &local();
+        std::unique_ptr<Snapshot> snapshot();
+        void describeStates(const std::vector<std::string> &names);
+
+    private:
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Shard>> shards;
+        std::vector<std::string> stateNames;
+    };
+
+    Registry &registry();
+
+    // status is the HTTP status of the round trip, anything from 400 up except 429 counts as an error
+    void recordRequest(Endpoint endpoint, int status, std::chrono::microseconds latency);
+    void recordRetry(Endpoint endpoint);
+    // time spent in a state, counted when the state is left
+    void recordStateDwell(int state, std::chrono::microseconds dwell);
+}
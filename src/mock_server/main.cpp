@@ -0,0 +1,57 @@
+#include "spdlog/spdlog.h"
+
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "mock_server.h"
+
+// usage: space-traders-mock [--port 8080] [--ships 3] [--time-scale 1] [--rate 2] [--burst 10]
+int main(int argc, char *argv[])
+{
+    int port = 8080;
+    mock::MockConfig config;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string flag = argv[i];
+        std::string value = argv[i + 1];
+        if (flag == "--port")
+        {
+            port = std::stoi(value);
+        }
+        else if (flag == "--ships")
+        {
+            config.shipCount = std::stoi(value);
+        }
+        else if (flag == "--time-scale")
+        {
+            config.timeScale = std::stod(value);
+        }
+        else if (flag == "--rate")
+        {
+            config.requestsPerSecond = std::stod(value);
+        }
+        else if (flag == "--burst")
+        {
+            config.burst = std::stoi(value);
+        }
+        else
+        {
+            spdlog::error("Unknown flag {}", flag);
+            return 1;
+        }
+    }
+
+    const std::string uri = "http://127.0.0.1:" + std::to_string(port) + "/v2/";
+    mock::MockServer server(uri, config);
+    server.open();
+    spdlog::info("Mock server listening on {} with {} ships at {}x time", uri, config.shipCount, config.timeScale);
+
+    while (true)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(60));
+        mock::MockStats stats = server.getStats();
+        spdlog::info("{} requests, {} rate limited, {} credits", stats.requests, stats.rateLimited, stats.credits);
+    }
+    return 0;
+}
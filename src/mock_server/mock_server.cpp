@@ -0,0 +1,202 @@
+#include "spdlog/spdlog.h"
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "mock_server.h"
+#include "../data_layer/error.h"
+
+using namespace mock;
+using namespace web;
+using namespace web::http;
+using namespace web::http::experimental::listener;
+
+MockServer::MockServer(const std::string &uri, const MockConfig &config)
+    : config(config), world(config), listener(U(uri)), tokens(config.burst),
+      lastRefill(std::chrono::steady_clock::now()), requests(0), rateLimitedCount(0)
+{
+    listener.support([this](http_request request)
+                     { handle(request); });
+}
+
+void MockServer::open()
+{
+    listener.open().wait();
+}
+
+void MockServer::close()
+{
+    listener.close().wait();
+}
+
+MockStats MockServer::getStats()
+{
+    return MockStats{requests.load(), rateLimitedCount.load(), world.getCredits()};
+}
+
+void MockServer::handle(http_request request)
+{
+    requests++;
+
+    double retryAfter;
+    if (!admit(retryAfter))
+    {
+        rateLimitedCount++;
+        reply(request, rateLimited(retryAfter));
+        return;
+    }
+
+    std::vector<std::string> path = uri::split_path(uri::decode(request.relative_uri().path()));
+    std::map<std::string, std::string> query = uri::split_query(request.relative_uri().query());
+    method requestMethod = request.method();
+    if (requestMethod == methods::POST || requestMethod == methods::PATCH)
+    {
+        // navigate, sell, deliver and the flight mode carry a payload, the rest post an empty body
+        request.extract_json(true)
+            .then([this, request, requestMethod, path, query](pplx::task<json::value> payload)
+                  {
+                      json::value body;
+                      try
+                      {
+                          body = payload.get();
+                      }
+                      catch (const std::exception &)
+                      {
+                          body = json::value::object();
+                      }
+                      reply(request, route(requestMethod, path, query, body)); });
+        return;
+    }
+
+    reply(request, route(requestMethod, path, query, json::value::object()));
+}
+
+Response MockServer::route(const method &requestMethod, const std::vector<std::string> &path, const std::map<std::string, std::string> &query, const json::value &payload)
+{
+    // paths are relative to the listener, e.g. my/ships/{symbol}/extract
+    try
+    {
+        if (path.size() >= 2 && path[0] == "my" && path[1] == "ships")
+        {
+            if (path.size() == 2 && requestMethod == methods::GET)
+            {
+                auto page = query.find("page");
+                auto limit = query.find("limit");
+                return world.getShips(page == query.end() ? 1 : std::atoi(page->second.c_str()), limit == query.end() ? 10 : std::atoi(limit->second.c_str()));
+            }
+            if (path.size() == 4)
+            {
+                const std::string &shipSymbol = path[2];
+                const std::string &action = path[3];
+                if (requestMethod == methods::GET && action == "cargo")
+                {
+                    return world.getCargo(shipSymbol);
+                }
+                if (requestMethod == methods::POST && action == "extract")
+                {
+                    return world.extract(shipSymbol);
+                }
+                if (requestMethod == methods::POST && action == "sell")
+                {
+                    return world.sell(shipSymbol, payload.at(U("symbol")).as_string(), payload.at(U("units")).as_integer());
+                }
+                if (requestMethod == methods::POST && action == "navigate")
+                {
+                    return world.navigate(shipSymbol, payload.at(U("waypointSymbol")).as_string());
+                }
+                if (requestMethod == methods::POST && action == "dock")
+                {
+                    return world.dock(shipSymbol);
+                }
+                if (requestMethod == methods::POST && action == "orbit")
+                {
+                    return world.orbit(shipSymbol);
+                }
+                if (requestMethod == methods::POST && action == "refuel")
+                {
+                    return world.refuel(shipSymbol);
+                }
+                if (requestMethod == methods::PATCH && action == "nav")
+                {
+                    return world.setFlightMode(shipSymbol, payload.at(U("flightMode")).as_string());
+                }
+            }
+        }
+        if (path.size() == 3 && path[0] == "systems" && path[2] == "waypoints" && requestMethod == methods::GET)
+        {
+            auto page = query.find("page");
+            auto limit = query.find("limit");
+            return world.getWaypoints(page == query.end() ? 1 : std::atoi(page->second.c_str()), limit == query.end() ? 10 : std::atoi(limit->second.c_str()));
+        }
+        if (path.size() == 5 && path[0] == "systems" && path[2] == "waypoints" && path[4] == "market" && requestMethod == methods::GET)
+        {
+            return world.getMarket(path[3]);
+        }
+        if (path.size() >= 2 && path[0] == "my" && path[1] == "contracts")
+        {
+            if (path.size() == 2 && requestMethod == methods::GET)
+            {
+                auto page = query.find("page");
+                auto limit = query.find("limit");
+                return world.getContracts(page == query.end() ? 1 : std::atoi(page->second.c_str()), limit == query.end() ? 10 : std::atoi(limit->second.c_str()));
+            }
+            if (path.size() == 4 && requestMethod == methods::POST && path[3] == "deliver")
+            {
+                return world.deliver(path[2], payload.at(U("shipSymbol")).as_string(), payload.at(U("tradeSymbol")).as_string(), payload.at(U("units")).as_integer());
+            }
+            if (path.size() == 4 && requestMethod == methods::POST && path[3] == "accept")
+            {
+                return world.acceptContract(path[2]);
+            }
+            if (path.size() == 4 && requestMethod == methods::POST && path[3] == "fulfill")
+            {
+                return world.fulfillContract(path[2]);
+            }
+        }
+    }
+    catch (const json::json_exception &e)
+    {
+        return World::error(status_codes::UnprocessableEntity, 422, fmt::format("Invalid request body: {}", e.what()), json::value::object());
+    }
+
+    return World::error(status_codes::NotFound, 404, "Route not found.", json::value::object());
+}
+
+void MockServer::reply(http_request request, const Response &response)
+{
+    // the Date header is what clients calibrate their clocks against
+    http_response reply(response.status);
+    reply.headers().add(U("Date"), toHttpDate(std::chrono::system_clock::now()));
+    reply.set_body(response.body);
+    request.reply(reply);
+}
+
+bool MockServer::admit(double &retryAfter)
+{
+    std::lock_guard<std::mutex> lock(bucketMutex);
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - lastRefill).count();
+    tokens = std::min((double)config.burst, tokens + elapsed * config.requestsPerSecond);
+    lastRefill = now;
+
+    if (tokens >= 1.0)
+    {
+        tokens -= 1.0;
+        return true;
+    }
+    retryAfter = (1.0 - tokens) / config.requestsPerSecond;
+    return false;
+}
+
+Response MockServer::rateLimited(double retryAfter)
+{
+    json::value data;
+    data[U("type")] = json::value::string("IP_ADDRESS");
+    data[U("retryAfter")] = json::value::number(retryAfter);
+    data[U("limitBurst")] = json::value::number(config.burst);
+    data[U("limitPerSecond")] = json::value::number(config.requestsPerSecond);
+    data[U("remaining")] = json::value::number(0);
+    return World::error(error::ErrorCode::RATE_LIMITED, error::ErrorCode::RATE_LIMITED,
+                        "You have reached your rate limit. Please wait before making more requests.", data);
+}
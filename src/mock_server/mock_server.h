@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cpprest/http_listener.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "world.h"
+
+namespace mock
+{
+    struct MockStats
+    {
+        long requests;
+        long rateLimited;
+        long credits;
+    };
+
+    class MockServer
+    {
+    public:
+        /* Stand-in for the SpaceTraders v2 API, serving the endpoints the DAL calls at uri.
+        Any bearer token is accepted, every agent shares one world.
+        */
+        MockServer(const std::string &uri, const MockConfig &config);
+
+        void open();
+        void close();
+        MockStats getStats();
+
+    private:
+        void handle(web::http::http_request request);
+        void reply(web::http::http_request request, const Response &response);
+        Response route(const web::http::method &requestMethod, const std::vector<std::string> &path, const std::map<std::string, std::string> &query, const web::json::value &payload);
+        bool admit(double &retryAfter);
+        Response rateLimited(double retryAfter);
+
+        MockConfig config;
+        World world;
+        web::http::experimental::listener::http_listener listener;
+
+        // token bucket mirroring the live limiter, refilled lazily on each request
+        std::mutex bucketMutex;
+        double tokens;
+        std::chrono::steady_clock::time_point lastRefill;
+
+        std::atomic<long> requests;
+        std::atomic<long> rateLimitedCount;
+    };
+}
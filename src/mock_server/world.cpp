@@ -0,0 +1,781 @@
+#include "spdlog/spdlog.h"
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+#include "world.h"
+#include "../data_layer/error.h"
+
+using namespace mock;
+using namespace web;
+using namespace web::http;
+
+// codes the live API uses that the client has no dedicated handling for
+const int SHIP_NOT_IN_ORBIT = 4236;
+const int SHIP_NOT_DOCKED = 4244;
+const int MARKET_TRADE_NOT_SOLD = 4602;
+const int CONTRACT_DELIVER_TERMS = 4509;
+const int CONTRACT_NOT_ACCEPTED = 4501;
+const int CONTRACT_ALREADY_ACCEPTED = 4502;
+const int CONTRACT_NOT_COMPLETE = 4503;
+const int CONTRACT_NOT_FOUND = 404;
+const int SHIP_NOT_FOUND = 404;
+const int MARKET_NOT_FOUND = 404;
+
+const std::string SYSTEM_SYMBOL = "X1-VS75";
+const int ENGINE_SPEED = 30;
+
+// travel time multiplier and fuel per unit of distance of every flight mode, DRIFT always burns 1
+struct FlightMode
+{
+    double timeMultiplier;
+    int fuelFactor;
+};
+const std::map<std::string, FlightMode> FLIGHT_MODES = {
+    {"CRUISE", {25, 1}}, {"BURN", {12.5, 2}}, {"DRIFT", {250, 0}}, {"STEALTH", {30, 1}}};
+
+std::string mock::toTimestamp(std::chrono::system_clock::time_point time)
+{
+    std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+    int milliseconds = (int)(std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count() % 1000);
+    std::tm tm = {};
+    gmtime_r(&seconds, &tm);
+    return fmt::format("{:04}-{:02}-{:02}T{:02}:{:02}:{:02}.{:03}Z",
+                       tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, milliseconds);
+}
+
+std::string mock::toHttpDate(std::chrono::system_clock::time_point time)
+{
+    std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+    std::tm tm = {};
+    gmtime_r(&seconds, &tm);
+    char date[32];
+    std::strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    return date;
+}
+
+World::World(const MockConfig &config) : config(config), credits(0), random(config.seed)
+{
+    // mirrors the system the automation is currently hardcoded against
+    waypoints["X1-VS75-67965Z"] = Waypoint{"X1-VS75-67965Z", "ASTEROID_FIELD", -3, 8,
+                                           {{"IRON_ORE", 38}, {"COPPER_ORE", 42}, {"ALUMINUM_ORE", 51}, {"QUARTZ_SAND", 20}, {"SILICON_CRYSTALS", 33}, {"ICE_WATER", 12}},
+                                           {"IRON_ORE", "COPPER_ORE", "ALUMINUM_ORE", "PLATINUM_ORE", "QUARTZ_SAND", "SILICON_CRYSTALS", "ICE_WATER"}};
+    waypoints["X1-VS75-70500X"] = Waypoint{"X1-VS75-70500X", "PLANET", 14, -22,
+                                           {{"IRON_ORE", 45}, {"COPPER_ORE", 47}, {"ALUMINUM_ORE", 58}, {"PLATINUM_ORE", 240}, {"FUEL", 122}},
+                                           {}};
+    waypoints["X1-VS75-97637F"] = Waypoint{"X1-VS75-97637F", "ORBITAL_STATION", 40, 31,
+                                           {{"QUARTZ_SAND", 31}, {"SILICON_CRYSTALS", 49}, {"ICE_WATER", 18}, {"FUEL", 118}},
+                                           {}};
+
+    // offered but not yet accepted, as a fresh agent finds it
+    contracts["clhw9qowb0139s60dm28j6y4p"] = Contract{"clhw9qowb0139s60dm28j6y4p", "PLATINUM_ORE", "X1-VS75-70500X", 100000, 0, 50000, 250000, false, false};
+
+    auto now = std::chrono::system_clock::now();
+    for (int i = 1; i <= config.shipCount; i++)
+    {
+        MockShip ship;
+        ship.symbol = fmt::format("MOCK-{}", i);
+        ship.waypointSymbol = "X1-VS75-67965Z";
+        ship.departureSymbol = ship.waypointSymbol;
+        ship.status = "IN_ORBIT";
+        ship.flightMode = "CRUISE";
+        ship.departureTime = now;
+        ship.arrival = now;
+        ship.cooldownUntil = now;
+        ship.fuel = config.fuelCapacity;
+        ship.fuelConsumed = 0;
+        ships[ship.symbol] = ship;
+    }
+}
+
+Response World::getShips(int page, int limit)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    limit = std::max(1, std::min(20, limit));
+    int first = (std::max(1, page) - 1) * limit;
+    json::value data = json::value::array();
+    size_t index = 0;
+    int position = 0;
+    for (auto &entry : ships)
+    {
+        if (position >= first && position < first + limit)
+        {
+            settle(entry.second);
+            data[index++] = shipJson(entry.second);
+        }
+        position++;
+    }
+
+    json::value body;
+    body[U("data")] = data;
+    body[U("meta")][U("total")] = json::value::number((int)ships.size());
+    body[U("meta")][U("page")] = json::value::number(page);
+    body[U("meta")][U("limit")] = json::value::number(limit);
+    return Response{status_codes::OK, body};
+}
+
+Response World::getCargo(const std::string &shipSymbol)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    MockShip *p_ship = findShip(shipSymbol);
+    if (p_ship == nullptr)
+    {
+        return notFound(shipSymbol);
+    }
+
+    json::value body;
+    body[U("data")] = cargoJson(*p_ship);
+    return Response{status_codes::OK, body};
+}
+
+Response World::extract(const std::string &shipSymbol)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    MockShip *p_ship = findShip(shipSymbol);
+    if (p_ship == nullptr)
+    {
+        return notFound(shipSymbol);
+    }
+    settle(*p_ship);
+    if (p_ship->status == "IN_TRANSIT")
+    {
+        return inTransit(*p_ship);
+    }
+    if (p_ship->status != "IN_ORBIT")
+    {
+        return error(status_codes::BadRequest, SHIP_NOT_IN_ORBIT, "Ship action requires ship to be in orbit.", json::value::object());
+    }
+
+    auto now = std::chrono::system_clock::now();
+    if (p_ship->cooldownUntil > now)
+    {
+        json::value data;
+        data[U("cooldown")][U("shipSymbol")] = json::value::string(shipSymbol);
+        data[U("cooldown")][U("totalSeconds")] = json::value::number(remainingSeconds(now + scaled(config.extractCooldown)));
+        data[U("cooldown")][U("remainingSeconds")] = json::value::number(remainingSeconds(p_ship->cooldownUntil));
+        data[U("cooldown")][U("expiration")] = json::value::string(toTimestamp(p_ship->cooldownUntil));
+        return error(status_codes::Conflict, error::ErrorCode::EXTRACT_COOLDOWN, "Ship action is still on cooldown.", data);
+    }
+
+    const Waypoint &waypoint = waypoints[p_ship->waypointSymbol];
+    if (waypoint.type != "ASTEROID_FIELD")
+    {
+        json::value data;
+        data[U("waypointSymbol")] = json::value::string(waypoint.symbol);
+        return error(status_codes::BadRequest, error::ErrorCode::EXTRACT_INVALID_WAYPOINT, "Ship extract failed. Waypoint is not an asteroid field.", data);
+    }
+
+    int freeSpace = config.cargoCapacity - cargoUnits(*p_ship);
+    if (freeSpace <= 0)
+    {
+        return error(status_codes::BadRequest, error::ErrorCode::FULL_CARGO, "Failed to update ship cargo. Cannot add more units to the ship's cargo.", json::value::object());
+    }
+
+    std::string symbol = waypoint.deposits[random() % waypoint.deposits.size()];
+    int units = std::min(freeSpace, (int)(random() % 10) + 3);
+    auto item = std::find_if(p_ship->inventory.begin(), p_ship->inventory.end(), [&symbol](const std::pair<std::string, int> &entry)
+                             { return entry.first == symbol; });
+    if (item == p_ship->inventory.end())
+    {
+        p_ship->inventory.emplace_back(symbol, units);
+    }
+    else
+    {
+        item->second += units;
+    }
+    p_ship->cooldownUntil = now + scaled(config.extractCooldown);
+
+    json::value data;
+    data[U("extraction")][U("shipSymbol")] = json::value::string(shipSymbol);
+    data[U("extraction")][U("yield")][U("symbol")] = json::value::string(symbol);
+    data[U("extraction")][U("yield")][U("units")] = json::value::number(units);
+    data[U("cooldown")][U("shipSymbol")] = json::value::string(shipSymbol);
+    data[U("cooldown")][U("totalSeconds")] = json::value::number(remainingSeconds(p_ship->cooldownUntil));
+    data[U("cooldown")][U("remainingSeconds")] = json::value::number(remainingSeconds(p_ship->cooldownUntil));
+    data[U("cooldown")][U("expiration")] = json::value::string(toTimestamp(p_ship->cooldownUntil));
+    data[U("cargo")] = cargoJson(*p_ship);
+
+    json::value body;
+    body[U("data")] = data;
+    return Response{status_codes::Created, body};
+}
+
+Response World::sell(const std::string &shipSymbol, const std::string &tradeSymbol, int units)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    MockShip *p_ship = findShip(shipSymbol);
+    if (p_ship == nullptr)
+    {
+        return notFound(shipSymbol);
+    }
+    settle(*p_ship);
+    if (p_ship->status == "IN_TRANSIT")
+    {
+        return inTransit(*p_ship);
+    }
+    if (p_ship->status != "DOCKED")
+    {
+        return error(status_codes::BadRequest, SHIP_NOT_DOCKED, "Ship action requires ship to be docked.", json::value::object());
+    }
+
+    const Waypoint &waypoint = waypoints[p_ship->waypointSymbol];
+    auto price = waypoint.prices.find(tradeSymbol);
+    auto item = std::find_if(p_ship->inventory.begin(), p_ship->inventory.end(), [&tradeSymbol](const std::pair<std::string, int> &entry)
+                             { return entry.first == tradeSymbol; });
+    if (price == waypoint.prices.end() || item == p_ship->inventory.end() || item->second < units || units <= 0)
+    {
+        json::value data;
+        data[U("waypointSymbol")] = json::value::string(waypoint.symbol);
+        data[U("tradeSymbol")] = json::value::string(tradeSymbol);
+        return error(status_codes::BadRequest, MARKET_TRADE_NOT_SOLD, "Market sell failed.", data);
+    }
+
+    item->second -= units;
+    if (item->second == 0)
+    {
+        p_ship->inventory.erase(item);
+    }
+    int totalPrice = price->second * units;
+    credits += totalPrice;
+
+    json::value data;
+    data[U("agent")][U("symbol")] = json::value::string("MOCK");
+    data[U("agent")][U("credits")] = json::value::number((int64_t)credits);
+    data[U("cargo")] = cargoJson(*p_ship);
+    data[U("transaction")][U("waypointSymbol")] = json::value::string(waypoint.symbol);
+    data[U("transaction")][U("shipSymbol")] = json::value::string(shipSymbol);
+    data[U("transaction")][U("tradeSymbol")] = json::value::string(tradeSymbol);
+    data[U("transaction")][U("type")] = json::value::string("SELL");
+    data[U("transaction")][U("units")] = json::value::number(units);
+    data[U("transaction")][U("pricePerUnit")] = json::value::number(price->second);
+    data[U("transaction")][U("totalPrice")] = json::value::number(totalPrice);
+    data[U("transaction")][U("timestamp")] = json::value::string(toTimestamp(std::chrono::system_clock::now()));
+
+    json::value body;
+    body[U("data")] = data;
+    return Response{status_codes::Created, body};
+}
+
+Response World::navigate(const std::string &shipSymbol, const std::string &waypointSymbol)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    MockShip *p_ship = findShip(shipSymbol);
+    if (p_ship == nullptr)
+    {
+        return notFound(shipSymbol);
+    }
+    settle(*p_ship);
+    if (p_ship->status == "IN_TRANSIT")
+    {
+        return inTransit(*p_ship);
+    }
+    if (p_ship->status != "IN_ORBIT")
+    {
+        return error(status_codes::BadRequest, SHIP_NOT_IN_ORBIT, "Ship action requires ship to be in orbit.", json::value::object());
+    }
+    if (p_ship->waypointSymbol == waypointSymbol)
+    {
+        json::value data;
+        data[U("destinationSymbol")] = json::value::string(waypointSymbol);
+        return error(status_codes::BadRequest, error::ErrorCode::NAVIGATE_SAME_LOCATION, "Navigate request failed. Ship is currently located at the destination.", data);
+    }
+    auto destination = waypoints.find(waypointSymbol);
+    if (destination == waypoints.end())
+    {
+        return error(status_codes::NotFound, SHIP_NOT_FOUND, fmt::format("Waypoint {} not found.", waypointSymbol), json::value::object());
+    }
+
+    const Waypoint &departure = waypoints[p_ship->waypointSymbol];
+    const FlightMode &mode = FLIGHT_MODES.at(p_ship->flightMode);
+    double distance = std::hypot(destination->second.x - departure.x, destination->second.y - departure.y);
+    int fuelRequired = std::max(1, (int)std::round(distance) * mode.fuelFactor);
+    if (fuelRequired > p_ship->fuel)
+    {
+        json::value data;
+        data[U("fuelRequired")] = json::value::number(fuelRequired);
+        data[U("fuelAvailable")] = json::value::number(p_ship->fuel);
+        return error(status_codes::BadRequest, error::ErrorCode::NAVIGATE_INSUFFICIENT_FUEL, "Navigate request failed. Ship does not have enough fuel.", data);
+    }
+
+    int travelSeconds = (int)std::round(std::round(std::max(1.0, distance)) * (mode.timeMultiplier / ENGINE_SPEED) + 15);
+    auto now = std::chrono::system_clock::now();
+    p_ship->fuel -= fuelRequired;
+    p_ship->fuelConsumed = fuelRequired;
+    p_ship->departureSymbol = p_ship->waypointSymbol;
+    p_ship->waypointSymbol = waypointSymbol;
+    p_ship->status = "IN_TRANSIT";
+    p_ship->departureTime = now;
+    p_ship->arrival = now + scaled(travelSeconds);
+
+    json::value data;
+    data[U("fuel")] = fuelJson(*p_ship);
+    data[U("nav")] = navJson(*p_ship);
+
+    json::value body;
+    body[U("data")] = data;
+    return Response{status_codes::OK, body};
+}
+
+Response World::dock(const std::string &shipSymbol)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    MockShip *p_ship = findShip(shipSymbol);
+    if (p_ship == nullptr)
+    {
+        return notFound(shipSymbol);
+    }
+    settle(*p_ship);
+    if (p_ship->status == "IN_TRANSIT")
+    {
+        return inTransit(*p_ship);
+    }
+    p_ship->status = "DOCKED";
+
+    json::value body;
+    body[U("data")][U("nav")] = navJson(*p_ship);
+    return Response{status_codes::OK, body};
+}
+
+Response World::orbit(const std::string &shipSymbol)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    MockShip *p_ship = findShip(shipSymbol);
+    if (p_ship == nullptr)
+    {
+        return notFound(shipSymbol);
+    }
+    settle(*p_ship);
+    if (p_ship->status == "IN_TRANSIT")
+    {
+        return inTransit(*p_ship);
+    }
+    p_ship->status = "IN_ORBIT";
+
+    json::value body;
+    body[U("data")][U("nav")] = navJson(*p_ship);
+    return Response{status_codes::OK, body};
+}
+
+Response World::refuel(const std::string &shipSymbol)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    MockShip *p_ship = findShip(shipSymbol);
+    if (p_ship == nullptr)
+    {
+        return notFound(shipSymbol);
+    }
+    settle(*p_ship);
+    if (p_ship->status == "IN_TRANSIT")
+    {
+        return inTransit(*p_ship);
+    }
+    if (p_ship->status != "DOCKED")
+    {
+        return error(status_codes::BadRequest, SHIP_NOT_DOCKED, "Ship action requires ship to be docked.", json::value::object());
+    }
+
+    const Waypoint &waypoint = waypoints[p_ship->waypointSymbol];
+    auto price = waypoint.prices.find("FUEL");
+    int units = config.fuelCapacity - p_ship->fuel;
+    int pricePerUnit = price == waypoint.prices.end() ? 0 : price->second;
+    // one unit of FUEL on the market refills 100 units of ship fuel
+    credits -= (long)pricePerUnit * ((units + 99) / 100);
+    p_ship->fuel = config.fuelCapacity;
+
+    json::value data;
+    data[U("agent")][U("symbol")] = json::value::string("MOCK");
+    data[U("agent")][U("credits")] = json::value::number((int64_t)credits);
+    data[U("fuel")] = fuelJson(*p_ship);
+
+    json::value body;
+    body[U("data")] = data;
+    return Response{status_codes::OK, body};
+}
+
+Response World::deliver(const std::string &contractId, const std::string &shipSymbol, const std::string &tradeSymbol, int units)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    MockShip *p_ship = findShip(shipSymbol);
+    if (p_ship == nullptr)
+    {
+        return notFound(shipSymbol);
+    }
+    settle(*p_ship);
+    if (p_ship->status == "IN_TRANSIT")
+    {
+        return inTransit(*p_ship);
+    }
+    if (p_ship->status != "DOCKED")
+    {
+        return error(status_codes::BadRequest, SHIP_NOT_DOCKED, "Ship action requires ship to be docked.", json::value::object());
+    }
+
+    auto contract = contracts.find(contractId);
+    auto item = std::find_if(p_ship->inventory.begin(), p_ship->inventory.end(), [&tradeSymbol](const std::pair<std::string, int> &entry)
+                             { return entry.first == tradeSymbol; });
+    if (contract != contracts.end() && !contract->second.accepted)
+    {
+        json::value data;
+        data[U("contractId")] = json::value::string(contractId);
+        return error(status_codes::BadRequest, CONTRACT_NOT_ACCEPTED, "Contract has not been accepted.", data);
+    }
+    if (contract == contracts.end() || contract->second.tradeSymbol != tradeSymbol || contract->second.destinationSymbol != p_ship->waypointSymbol || item == p_ship->inventory.end() || item->second < units || units <= 0)
+    {
+        json::value data;
+        data[U("contractId")] = json::value::string(contractId);
+        data[U("tradeSymbol")] = json::value::string(tradeSymbol);
+        return error(status_codes::BadRequest, CONTRACT_DELIVER_TERMS, "Contract deliver failed, the terms do not match.", data);
+    }
+
+    units = std::min(units, contract->second.unitsRequired - contract->second.unitsFulfilled);
+    item->second -= units;
+    if (item->second == 0)
+    {
+        p_ship->inventory.erase(item);
+    }
+    contract->second.unitsFulfilled += units;
+
+    json::value data;
+    data[U("contract")] = contractJson(contract->second);
+    data[U("cargo")] = cargoJson(*p_ship);
+
+    json::value body;
+    body[U("data")] = data;
+    return Response{status_codes::OK, body};
+}
+
+Response World::getMarket(const std::string &waypointSymbol)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto waypoint = waypoints.find(waypointSymbol);
+    if (waypoint == waypoints.end() || waypoint->second.prices.empty())
+    {
+        return error(status_codes::NotFound, MARKET_NOT_FOUND, fmt::format("Market {} not found.", waypointSymbol), json::value::object());
+    }
+
+    // one price per good, the mock market has no spread and never runs out
+    json::value goods = json::value::array(waypoint->second.prices.size());
+    size_t index = 0;
+    for (auto &price : waypoint->second.prices)
+    {
+        json::value good;
+        good[U("symbol")] = json::value::string(price.first);
+        good[U("tradeVolume")] = json::value::number(100);
+        good[U("supply")] = json::value::string("MODERATE");
+        good[U("purchasePrice")] = json::value::number(price.second);
+        good[U("sellPrice")] = json::value::number(price.second);
+        goods[index++] = good;
+    }
+
+    json::value exchange = json::value::array(waypoint->second.prices.size());
+    index = 0;
+    for (auto &price : waypoint->second.prices)
+    {
+        exchange[index][U("symbol")] = json::value::string(price.first);
+        exchange[index][U("name")] = json::value::string(price.first);
+        exchange[index][U("description")] = json::value::string("");
+        index++;
+    }
+
+    json::value body;
+    body[U("data")][U("symbol")] = json::value::string(waypointSymbol);
+    body[U("data")][U("imports")] = json::value::array();
+    body[U("data")][U("exports")] = json::value::array();
+    body[U("data")][U("exchange")] = exchange;
+    body[U("data")][U("tradeGoods")] = goods;
+    return Response{status_codes::OK, body};
+}
+
+Response World::getContracts(int page, int limit)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    limit = std::max(1, std::min(20, limit));
+    int first = (std::max(1, page) - 1) * limit;
+    json::value data = json::value::array();
+    size_t index = 0;
+    int position = 0;
+    for (auto &entry : contracts)
+    {
+        if (position >= first && position < first + limit)
+        {
+            data[index++] = contractJson(entry.second);
+        }
+        position++;
+    }
+
+    json::value body;
+    body[U("data")] = data;
+    body[U("meta")][U("total")] = json::value::number((int)contracts.size());
+    body[U("meta")][U("page")] = json::value::number(page);
+    body[U("meta")][U("limit")] = json::value::number(limit);
+    return Response{status_codes::OK, body};
+}
+
+Response World::acceptContract(const std::string &contractId)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto contract = contracts.find(contractId);
+    if (contract == contracts.end())
+    {
+        return error(status_codes::NotFound, CONTRACT_NOT_FOUND, fmt::format("Contract {} not found.", contractId), json::value::object());
+    }
+    if (contract->second.accepted)
+    {
+        return error(status_codes::BadRequest, CONTRACT_ALREADY_ACCEPTED, "Contract has already been accepted.", json::value::object());
+    }
+
+    contract->second.accepted = true;
+    credits += contract->second.onAccepted;
+
+    json::value data;
+    data[U("agent")][U("symbol")] = json::value::string("MOCK");
+    data[U("agent")][U("credits")] = json::value::number((int64_t)credits);
+    data[U("contract")] = contractJson(contract->second);
+
+    json::value body;
+    body[U("data")] = data;
+    return Response{status_codes::OK, body};
+}
+
+Response World::fulfillContract(const std::string &contractId)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto contract = contracts.find(contractId);
+    if (contract == contracts.end())
+    {
+        return error(status_codes::NotFound, CONTRACT_NOT_FOUND, fmt::format("Contract {} not found.", contractId), json::value::object());
+    }
+    if (!contract->second.accepted || contract->second.fulfilled || contract->second.unitsFulfilled < contract->second.unitsRequired)
+    {
+        return error(status_codes::BadRequest, CONTRACT_NOT_COMPLETE, "Contract terms have not been met.", json::value::object());
+    }
+
+    contract->second.fulfilled = true;
+    credits += contract->second.onFulfilled;
+
+    json::value data;
+    data[U("agent")][U("symbol")] = json::value::string("MOCK");
+    data[U("agent")][U("credits")] = json::value::number((int64_t)credits);
+    data[U("contract")] = contractJson(contract->second);
+
+    json::value body;
+    body[U("data")] = data;
+    return Response{status_codes::OK, body};
+}
+
+Response World::getWaypoints(int page, int limit)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    limit = std::max(1, std::min(20, limit));
+    int first = (std::max(1, page) - 1) * limit;
+    json::value data = json::value::array();
+    size_t index = 0;
+    int position = 0;
+    for (auto &entry : waypoints)
+    {
+        if (position >= first && position < first + limit)
+        {
+            data[index++] = waypointJson(entry.second);
+        }
+        position++;
+    }
+
+    json::value body;
+    body[U("data")] = data;
+    body[U("meta")][U("total")] = json::value::number((int)waypoints.size());
+    body[U("meta")][U("page")] = json::value::number(page);
+    body[U("meta")][U("limit")] = json::value::number(limit);
+    return Response{status_codes::OK, body};
+}
+
+Response World::setFlightMode(const std::string &shipSymbol, const std::string &flightMode)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    MockShip *p_ship = findShip(shipSymbol);
+    if (p_ship == nullptr)
+    {
+        return notFound(shipSymbol);
+    }
+    if (FLIGHT_MODES.count(flightMode) == 0)
+    {
+        return error(status_codes::UnprocessableEntity, 422, fmt::format("Invalid flight mode {}.", flightMode), json::value::object());
+    }
+    // the new mode applies from the next departure
+    settle(*p_ship);
+    p_ship->flightMode = flightMode;
+
+    json::value body;
+    body[U("data")] = navJson(*p_ship);
+    return Response{status_codes::OK, body};
+}
+
+long World::getCredits()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return credits;
+}
+
+Response World::error(status_code status, int code, const std::string &message, const json::value &data)
+{
+    json::value body;
+    body[U("error")][U("message")] = json::value::string(message);
+    body[U("error")][U("code")] = json::value::number(code);
+    body[U("error")][U("data")] = data;
+    return Response{status, body};
+}
+
+MockShip *World::findShip(const std::string &shipSymbol)
+{
+    auto ship = ships.find(shipSymbol);
+    return ship == ships.end() ? nullptr : &ship->second;
+}
+
+void World::settle(MockShip &ship)
+{
+    if (ship.status == "IN_TRANSIT" && std::chrono::system_clock::now() >= ship.arrival)
+    {
+        ship.status = "IN_ORBIT";
+    }
+}
+
+Response World::notFound(const std::string &shipSymbol)
+{
+    json::value data;
+    data[U("shipSymbol")] = json::value::string(shipSymbol);
+    return error(status_codes::NotFound, SHIP_NOT_FOUND, fmt::format("Ship {} not found.", shipSymbol), data);
+}
+
+Response World::inTransit(const MockShip &ship)
+{
+    json::value data;
+    data[U("departureSymbol")] = json::value::string(ship.departureSymbol);
+    data[U("destinationSymbol")] = json::value::string(ship.waypointSymbol);
+    data[U("arrival")] = json::value::string(toTimestamp(ship.arrival));
+    data[U("departureTime")] = json::value::string(toTimestamp(ship.departureTime));
+    data[U("secondsToArrival")] = json::value::number(remainingSeconds(ship.arrival));
+    return error(status_codes::BadRequest, error::ErrorCode::IN_TRANSIT, "Ship is currently in-transit.", data);
+}
+
+int World::cargoUnits(const MockShip &ship) const
+{
+    int units = 0;
+    for (const auto &item : ship.inventory)
+    {
+        units += item.second;
+    }
+    return units;
+}
+
+std::chrono::milliseconds World::scaled(int seconds) const
+{
+    return std::chrono::milliseconds((long long)(seconds * 1000.0 / config.timeScale));
+}
+
+int World::remainingSeconds(std::chrono::system_clock::time_point until) const
+{
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(until - std::chrono::system_clock::now()).count();
+    return remaining <= 0 ? 0 : (int)((remaining + 999) / 1000);
+}
+
+json::value World::waypointJson(const Waypoint &waypoint) const
+{
+    json::value json;
+    json[U("symbol")] = json::value::string(waypoint.symbol);
+    json[U("type")] = json::value::string(waypoint.type);
+    json[U("systemSymbol")] = json::value::string(SYSTEM_SYMBOL);
+    json[U("x")] = json::value::number(waypoint.x);
+    json[U("y")] = json::value::number(waypoint.y);
+    json[U("traits")] = json::value::array();
+    if (!waypoint.prices.empty())
+    {
+        json[U("traits")][0][U("symbol")] = json::value::string("MARKETPLACE");
+        json[U("traits")][0][U("name")] = json::value::string("Marketplace");
+        json[U("traits")][0][U("description")] = json::value::string("");
+    }
+    return json;
+}
+
+json::value World::cargoJson(const MockShip &ship) const
+{
+    json::value inventory = json::value::array(ship.inventory.size());
+    for (size_t i = 0; i < ship.inventory.size(); i++)
+    {
+        inventory[i][U("symbol")] = json::value::string(ship.inventory[i].first);
+        inventory[i][U("name")] = json::value::string(ship.inventory[i].first);
+        inventory[i][U("description")] = json::value::string("");
+        inventory[i][U("units")] = json::value::number(ship.inventory[i].second);
+    }
+
+    json::value json;
+    json[U("capacity")] = json::value::number(config.cargoCapacity);
+    json[U("units")] = json::value::number(cargoUnits(ship));
+    json[U("inventory")] = inventory;
+    return json;
+}
+
+json::value World::fuelJson(const MockShip &ship) const
+{
+    json::value json;
+    json[U("current")] = json::value::number(ship.fuel);
+    json[U("capacity")] = json::value::number(config.fuelCapacity);
+    json[U("consumed")][U("amount")] = json::value::number(ship.fuelConsumed);
+    json[U("consumed")][U("timestamp")] = json::value::string(toTimestamp(ship.departureTime));
+    return json;
+}
+
+json::value World::navJson(const MockShip &ship) const
+{
+    json::value json;
+    json[U("systemSymbol")] = json::value::string(SYSTEM_SYMBOL);
+    json[U("waypointSymbol")] = json::value::string(ship.waypointSymbol);
+    json[U("route")][U("departure")] = waypointJson(waypoints.at(ship.departureSymbol));
+    json[U("route")][U("destination")] = waypointJson(waypoints.at(ship.waypointSymbol));
+    json[U("route")][U("arrival")] = json::value::string(toTimestamp(ship.arrival));
+    json[U("route")][U("departureTime")] = json::value::string(toTimestamp(ship.departureTime));
+    json[U("status")] = json::value::string(ship.status);
+    json[U("flightMode")] = json::value::string(ship.flightMode);
+    return json;
+}
+
+json::value World::shipJson(const MockShip &ship) const
+{
+    json::value mount;
+    mount[U("symbol")] = json::value::string("MOUNT_MINING_LASER_I");
+    mount[U("name")] = json::value::string("Mining Laser I");
+    mount[U("strength")] = json::value::number(10);
+
+    json::value json;
+    json[U("symbol")] = json::value::string(ship.symbol);
+    json[U("registration")][U("name")] = json::value::string(ship.symbol);
+    json[U("registration")][U("factionSymbol")] = json::value::string("COSMIC");
+    json[U("registration")][U("role")] = json::value::string("EXCAVATOR");
+    json[U("nav")] = navJson(ship);
+    json[U("mounts")] = json::value::array(1);
+    json[U("mounts")][0] = mount;
+    json[U("cargo")] = cargoJson(ship);
+    json[U("fuel")] = fuelJson(ship);
+    return json;
+}
+
+json::value World::contractJson(const Contract &contract) const
+{
+    json::value deliver;
+    deliver[U("tradeSymbol")] = json::value::string(contract.tradeSymbol);
+    deliver[U("destinationSymbol")] = json::value::string(contract.destinationSymbol);
+    deliver[U("unitsRequired")] = json::value::number(contract.unitsRequired);
+    deliver[U("unitsFulfilled")] = json::value::number(contract.unitsFulfilled);
+
+    json::value json;
+    json[U("id")] = json::value::string(contract.id);
+    json[U("factionSymbol")] = json::value::string("COSMIC");
+    json[U("type")] = json::value::string("PROCUREMENT");
+    json[U("terms")][U("payment")][U("onAccepted")] = json::value::number(contract.onAccepted);
+    json[U("terms")][U("payment")][U("onFulfilled")] = json::value::number(contract.onFulfilled);
+    json[U("terms")][U("deliver")] = json::value::array(1);
+    json[U("terms")][U("deliver")][0] = deliver;
+    json[U("accepted")] = json::value::boolean(contract.accepted);
+    json[U("fulfilled")] = json::value::boolean(contract.fulfilled);
+    return json;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cpprest/http_msg.h>
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace mock
+{
+    struct MockConfig
+    {
+        int shipCount = 3;
+        // simulated seconds per real second, cooldowns and travel shrink accordingly
+        double timeScale = 1.0;
+        // server side limits, a request over them is answered with a 429
+        double requestsPerSecond = 2.0;
+        int burst = 10;
+        int extractCooldown = 70;
+        int cargoCapacity = 60;
+        int fuelCapacity = 1200;
+        unsigned int seed = 42;
+    };
+
+    struct Response
+    {
+        web::http::status_code status;
+        web::json::value body;
+    };
+
+    struct Waypoint
+    {
+        std::string symbol;
+        std::string type;
+        int x;
+        int y;
+        std::map<std::string, int> prices;
+        std::vector<std::string> deposits;
+    };
+
+    struct MockShip
+    {
+        std::string symbol;
+        std::string waypointSymbol;
+        std::string departureSymbol;
+        std::string status;
+        std::string flightMode;
+        std::chrono::system_clock::time_point departureTime;
+        std::chrono::system_clock::time_point arrival;
+        std::chrono::system_clock::time_point cooldownUntil;
+        int fuel;
+        int fuelConsumed;
+        std::vector<std::pair<std::string, int>> inventory;
+    };
+
+    struct Contract
+    {
+        std::string id;
+        std::string tradeSymbol;
+        std::string destinationSymbol;
+        int unitsRequired;
+        int unitsFulfilled;
+        int onAccepted;
+        int onFulfilled;
+        bool accepted;
+        bool fulfilled;
+    };
+
+    class World
+    {
+    public:
+        World(const MockConfig &config);
+
+        Response getShips(int page, int limit);
+        Response getCargo(const std::string &shipSymbol);
+        Response extract(const std::string &shipSymbol);
+        Response sell(const std::string &shipSymbol, const std::string &tradeSymbol, int units);
+        Response navigate(const std::string &shipSymbol, const std::string &waypointSymbol);
+        Response dock(const std::string &shipSymbol);
+        Response orbit(const std::string &shipSymbol);
+        Response refuel(const std::string &shipSymbol);
+        Response deliver(const std::string &contractId, const std::string &shipSymbol, const std::string &tradeSymbol, int units);
+        Response getMarket(const std::string &waypointSymbol);
+        Response getWaypoints(int page, int limit);
+        Response setFlightMode(const std::string &shipSymbol, const std::string &flightMode);
+        Response getContracts(int page, int limit);
+        Response acceptContract(const std::string &contractId);
+        Response fulfillContract(const std::string &contractId);
+        long getCredits();
+
+        static Response error(web::http::status_code status, int code, const std::string &message, const web::json::value &data);
+
+    private:
+        /* Game rules only, no HTTP. Every public call takes the world lock, settles ships whose
+        travel has finished and answers with the JSON the live API would send.
+        */
+        MockShip *findShip(const std::string &shipSymbol);
+        void settle(MockShip &ship);
+        Response notFound(const std::string &shipSymbol);
+        Response inTransit(const MockShip &ship);
+        int cargoUnits(const MockShip &ship) const;
+        std::chrono::milliseconds scaled(int seconds) const;
+        int remainingSeconds(std::chrono::system_clock::time_point until) const;
+
+        web::json::value waypointJson(const Waypoint &waypoint) const;
+        web::json::value cargoJson(const MockShip &ship) const;
+        web::json::value fuelJson(const MockShip &ship) const;
+        web::json::value navJson(const MockShip &ship) const;
+        web::json::value shipJson(const MockShip &ship) const;
+        web::json::value contractJson(const Contract &contract) const;
+
+        MockConfig config;
+        std::map<std::string, Waypoint> waypoints;
+        std::map<std::string, MockShip> ships;
+        std::map<std::string, Contract> contracts;
+        long credits;
+        std::mt19937 random;
+        std::mutex mutex;
+    };
+
+    std::string toTimestamp(std::chrono::system_clock::time_point time);
+    std::string toHttpDate(std::chrono::system_clock::time_point time);
+}